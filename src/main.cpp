@@ -1,6 +1,7 @@
 #include <goal_control.hpp>
-#include <Teuchos_YamlParameterListHelpers.hpp>
+#include <PCU.h>
 #include "ml_solver.hpp"
+#include "ml_startup.hpp"
 
 int main(int argc, char** argv) {
   goal::initialize();
@@ -9,10 +10,11 @@ int main(int argc, char** argv) {
   try {
     const char* in = argv[1];
     goal::print("reading input file: %s", in);
-    Teuchos::ParameterList p;
-    auto pp = Teuchos::Ptr<Teuchos::ParameterList>(&p);
-    Teuchos::updateParametersFromYamlFile(in, pp);
+    auto t0 = PCU_Time();
+    auto p = ml::read_input(in);
     auto solver = ml::create_solver(p);
+    auto t1 = PCU_Time();
+    goal::print(" > startup time: %f seconds", t1 - t0);
     solver->solve();
     ml::destroy_solver(solver);
   } catch (std::exception const& ex) {
@@ -0,0 +1,214 @@
+#include <cmath>
+#include <apf.h>
+#include <apfMesh2.h>
+#include <goal_control.hpp>
+#include <goal_discretization.hpp>
+#include <goal_states.hpp>
+#include <ma.h>
+#include <MiniTensor.h>
+#include <PCU.h>
+
+#include "ml_adapt.hpp"
+#include "ml_mechanics.hpp"
+
+namespace ml {
+
+static double get_avg_edge_length(apf::Mesh* mesh, apf::MeshEntity* elem) {
+  apf::Downward edges;
+  int num_edges = mesh->getDownward(elem, 1, edges);
+  double h = 0.0;
+  for (int i = 0; i < num_edges; ++i)
+    h += apf::measure(mesh, edges[i]);
+  return h / num_edges;
+}
+
+static void average(apf::Field* f, apf::Field* weights) {
+  auto mesh = apf::getMesh(f);
+  auto n = apf::countComponents(f);
+  std::vector<double> values(n);
+  apf::accumulate(f);
+  apf::accumulate(weights);
+  apf::MeshEntity* vtx;
+  auto it = mesh->begin(0);
+  while ((vtx = mesh->iterate(it))) {
+    double w = apf::getScalar(weights, vtx, 0);
+    apf::getComponents(f, vtx, 0, &values[0]);
+    for (int i = 0; i < n; ++i)
+      values[i] /= w;
+    apf::setComponents(f, vtx, 0, &values[0]);
+  }
+  mesh->end(it);
+}
+
+static apf::Field* get_size_field(
+    ParameterList const& p, Mechanics* m, goal::Discretization* d) {
+
+  // target an equidistribution of the error across the elements
+  auto mesh = d->get_apf_mesh();
+  auto dim = mesh->getDimension();
+  auto error = m->get_error_field();
+  auto target = p.get<double>("target error");
+  long num_elems = mesh->count(dim);
+  PCU_Add_Longs(&num_elems, 1);
+  double eta_target = target / num_elems;
+  double exponent = 1.0 / (m->get_p_order() + 1.0);
+
+  // volume average the new element sizes to the vertices
+  auto size = apf::createFieldOn(mesh, "size", apf::SCALAR);
+  auto weights = apf::createFieldOn(mesh, "size_weights", apf::SCALAR);
+  apf::zeroField(size);
+  apf::zeroField(weights);
+  apf::Downward verts;
+  apf::MeshEntity* elem;
+  auto it = mesh->begin(dim);
+  while ((elem = mesh->iterate(it))) {
+    double eta = std::abs(apf::getScalar(error, elem, 0));
+    double ratio = std::pow(eta_target / std::max(eta, 1.0e-300), exponent);
+    ratio = std::min(std::max(ratio, 0.25), 2.0);
+    double h = ratio * get_avg_edge_length(mesh, elem);
+    double vol = apf::measure(mesh, elem);
+    int num_verts = mesh->getDownward(elem, 0, verts);
+    for (int i = 0; i < num_verts; ++i) {
+      apf::setScalar(size, verts[i], 0,
+          apf::getScalar(size, verts[i], 0) + h * vol);
+      apf::setScalar(weights, verts[i], 0,
+          apf::getScalar(weights, verts[i], 0) + vol);
+    }
+  }
+  mesh->end(it);
+  average(size, weights);
+  apf::destroyField(weights);
+  return size;
+}
+
+static void project_history(
+    Mechanics* m, goal::Discretization* d, apf::Field* eqps, apf::Field* Fp) {
+
+  // volume average the history at the start of the step to the vertices
+  auto mesh = d->get_apf_mesh();
+  auto dim = mesh->getDimension();
+  auto states = m->get_states();
+  auto q_degree = m->get_q_degree();
+  auto weights = apf::createFieldOn(mesh, "history_weights", apf::SCALAR);
+  apf::zeroField(eqps);
+  apf::zeroField(Fp);
+  apf::zeroField(weights);
+  double eqps_ip;
+  minitensor::Tensor<double> Fp_ip(dim);
+  apf::Downward verts;
+  apf::MeshEntity* elem;
+  auto it = mesh->begin(dim);
+  while ((elem = mesh->iterate(it))) {
+    double eqps_avg = 0.0;
+    apf::Matrix3x3 Fp_avg(0, 0, 0, 0, 0, 0, 0, 0, 0);
+    auto me = apf::createMeshElement(mesh, elem);
+    int num_ips = apf::countIntPoints(me, q_degree);
+    for (int ip = 0; ip < num_ips; ++ip) {
+      states->get_scalar("eqps_old", elem, ip, eqps_ip);
+      states->get_tensor("Fp_old", elem, ip, Fp_ip);
+      eqps_avg += eqps_ip / num_ips;
+      for (int i = 0; i < dim; ++i)
+      for (int j = 0; j < dim; ++j)
+        Fp_avg[i][j] += Fp_ip(i, j) / num_ips;
+    }
+    apf::destroyMeshElement(me);
+    double vol = apf::measure(mesh, elem);
+    int num_verts = mesh->getDownward(elem, 0, verts);
+    for (int v = 0; v < num_verts; ++v) {
+      apf::Matrix3x3 Fp_vtx;
+      apf::getMatrix(Fp, verts[v], 0, Fp_vtx);
+      apf::setMatrix(Fp, verts[v], 0, Fp_vtx + Fp_avg * vol);
+      apf::setScalar(eqps, verts[v], 0,
+          apf::getScalar(eqps, verts[v], 0) + eqps_avg * vol);
+      apf::setScalar(weights, verts[v], 0,
+          apf::getScalar(weights, verts[v], 0) + vol);
+    }
+  }
+  mesh->end(it);
+  average(eqps, weights);
+  average(Fp, weights);
+  apf::destroyField(weights);
+}
+
+static void restore_history(
+    Mechanics* m, goal::Discretization* d, apf::Field* eqps, apf::Field* Fp) {
+
+  // interpolate the nodal history to the integration points
+  auto mesh = d->get_apf_mesh();
+  auto dim = mesh->getDimension();
+  auto states = m->get_states();
+  auto q_degree = m->get_q_degree();
+  apf::Vector3 xi;
+  apf::Matrix3x3 Fp_xi;
+  minitensor::Tensor<double> Fp_ip(dim);
+  apf::MeshEntity* elem;
+  auto it = mesh->begin(dim);
+  while ((elem = mesh->iterate(it))) {
+    auto me = apf::createMeshElement(mesh, elem);
+    auto eqps_elem = apf::createElement(eqps, me);
+    auto Fp_elem = apf::createElement(Fp, me);
+    for (int ip = 0; ip < apf::countIntPoints(me, q_degree); ++ip) {
+      apf::getIntPoint(me, q_degree, ip, xi);
+      double eqps_ip = apf::getScalar(eqps_elem, xi);
+      apf::getMatrix(Fp_elem, xi, Fp_xi);
+      for (int i = 0; i < dim; ++i)
+      for (int j = 0; j < dim; ++j)
+        Fp_ip(i, j) = Fp_xi[i][j];
+      // averaging does not preserve the isochoric plastic flow, so the
+      // interpolated Fp is scaled back to det Fp = 1
+      double det = minitensor::det(Fp_ip);
+      GOAL_ALWAYS_ASSERT(det > 0.0);
+      Fp_ip /= std::pow(det, 1.0 / dim);
+      states->set_scalar("eqps", elem, ip, eqps_ip);
+      states->set_scalar("eqps_old", elem, ip, eqps_ip);
+      states->set_tensor("Fp", elem, ip, Fp_ip);
+      states->set_tensor("Fp_old", elem, ip, Fp_ip);
+    }
+    apf::destroyElement(Fp_elem);
+    apf::destroyElement(eqps_elem);
+    apf::destroyMeshElement(me);
+  }
+  mesh->end(it);
+}
+
+void adapt_mesh(
+    ParameterList const& p, Mechanics* m, goal::Discretization* d) {
+
+  auto t0 = PCU_Time();
+  auto mesh = d->get_apf_mesh();
+  auto size = get_size_field(p, m, d);
+
+  // transfer the history through temporary nodal fields
+  apf::Field* eqps = 0;
+  apf::Field* Fp = 0;
+  bool has_history = m->has_history();
+  if (has_history) {
+    eqps = apf::createFieldOn(mesh, "eqps_nodal", apf::SCALAR);
+    Fp = apf::createFieldOn(mesh, "Fp_nodal", apf::MATRIX);
+    project_history(m, d, eqps, Fp);
+  }
+  m->pre_adapt();
+
+  // locally refine and coarsen the mesh
+  auto in = ma::configure(d->get_apf_mesh(), size);
+  in->shouldRunPreZoltan = true;
+  in->shouldRunMidZoltan = true;
+  in->shouldRunPostZoltan = true;
+  in->maximumIterations = p.get<int>("adapt iters");
+  ma::adapt(in);
+  apf::destroyField(size);
+
+  // rebuild the discretization and the mechanics data
+  d->update();
+  m->post_adapt();
+  if (has_history) {
+    restore_history(m, d, eqps, Fp);
+    apf::destroyField(eqps);
+    apf::destroyField(Fp);
+  }
+
+  auto t1 = PCU_Time();
+  goal::print(" > mesh adapted in %f seconds", t1 - t0);
+}
+
+} // end namespace ml
@@ -0,0 +1,36 @@
+#ifndef ml_adapt_hpp
+#define ml_adapt_hpp
+
+/// @file ml_adapt.hpp
+
+#include <Teuchos_ParameterList.hpp>
+
+/// @cond
+namespace goal {
+class Discretization;
+}
+/// @endcond
+
+namespace ml {
+
+using Teuchos::ParameterList;
+
+/// @cond
+class Mechanics;
+/// @endcond
+
+/// @brief Adapt the mesh based on the element-wise error indicators.
+/// @param p The adaptation parameter list.
+/// @param m The mechanics object with computed error indicators.
+/// @param d The relevant discretization object.
+/// @details An isotropic size field is computed that equidistributes
+/// the target error across the elements. The history states are projected
+/// to temporary nodal fields, the mesh is locally refined and coarsened
+/// with MeshAdapt, and the states are then interpolated back to the
+/// integration points of the new mesh. The displacement fields are
+/// transferred in memory by MeshAdapt itself.
+void adapt_mesh(ParameterList const& p, Mechanics* m, goal::Discretization* d);
+
+} // end namespace ml
+
+#endif
@@ -0,0 +1,96 @@
+#include <goal_control.hpp>
+#include <Teuchos_SerialDenseMatrix.hpp>
+#include <Teuchos_SerialDenseSolver.hpp>
+
+#include "ml_anderson.hpp"
+
+namespace ml {
+
+using DenseMatrix = Teuchos::SerialDenseMatrix<int, double>;
+using DenseSolver = Teuchos::SerialDenseSolver<int, double>;
+
+Anderson::Anderson(Teuchos::RCP<const Map> m, int w, double b)
+    : map(m),
+      window(w),
+      mixing(b) {
+  GOAL_ALWAYS_ASSERT(window >= 0);
+  GOAL_ALWAYS_ASSERT(mixing > 0.0);
+}
+
+void Anderson::reset() {
+  f_old = Teuchos::null;
+  s_old = Teuchos::null;
+  dF.clear();
+  dS.clear();
+}
+
+bool Anderson::solve_least_squares(
+    Teuchos::RCP<goal::Vector> f,
+    std::vector<double>& gamma) {
+  int m = int(dF.size());
+  DenseMatrix N(m, m);
+  DenseMatrix b(m, 1);
+  for (int i = 0; i < m; ++i) {
+    b(i, 0) = dF[i]->dot(*f);
+    for (int j = i; j < m; ++j) {
+      N(i, j) = dF[i]->dot(*dF[j]);
+      N(j, i) = N(i, j);
+    }
+  }
+  auto X = Teuchos::rcp(new DenseMatrix(m, 1));
+  DenseSolver solver;
+  solver.setMatrix(Teuchos::rcpFromRef(N));
+  solver.setVectors(X, Teuchos::rcpFromRef(b));
+  solver.factorWithEquilibration(true);
+  if (solver.solve() != 0) return false;
+  gamma.resize(m);
+  for (int i = 0; i < m; ++i)
+    gamma[i] = (*X)(i, 0);
+  return true;
+}
+
+void Anderson::compute_step(
+    Teuchos::RCP<goal::Vector> f,
+    Teuchos::RCP<goal::Vector> s) {
+
+  // update the history with the newest differences
+  if (Teuchos::nonnull(f_old) && (window > 0)) {
+    auto df = Teuchos::rcp(new goal::Vector(map));
+    df->update(1.0, *f, -1.0, *f_old, 0.0);
+    dF.push_back(df);
+    dS.push_back(s_old);
+    if (int(dF.size()) > window) {
+      dF.pop_front();
+      dS.pop_front();
+    }
+  }
+
+  // the damped fixed point step, corrected by the history
+  std::vector<double> gamma;
+  s->update(mixing, *f, 0.0);
+  if ((! dF.empty()) && solve_least_squares(f, gamma)) {
+    for (size_t i = 0; i < gamma.size(); ++i) {
+      s->update(-gamma[i], *dS[i], 1.0);
+      s->update(-mixing * gamma[i], *dF[i], 1.0);
+    }
+  } else if (! dF.empty()) {
+    reset();
+  }
+
+  // keep copies for the next differences
+  f_old = Teuchos::rcp(new goal::Vector(map));
+  s_old = Teuchos::rcp(new goal::Vector(map));
+  f_old->update(1.0, *f, 0.0);
+  s_old->update(1.0, *s, 0.0);
+}
+
+Anderson* create_anderson(
+    Teuchos::RCP<const Map> map, int window, double mixing) {
+  return new Anderson(map, window, mixing);
+}
+
+void destroy_anderson(Anderson* a) {
+  delete a;
+}
+
+} // end namespace ml
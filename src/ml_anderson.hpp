@@ -0,0 +1,76 @@
+#ifndef ml_anderson_hpp
+#define ml_anderson_hpp
+
+/// @file ml_anderson.hpp
+
+#include <deque>
+#include "ml_linear_algebra.hpp"
+
+namespace ml {
+
+/// @brief Anderson acceleration of a fixed point iteration.
+/// @details For the fixed point map \f$ g(u) = u + f(u) \f$, with the
+/// fixed point residual \f$ f(u) = -J_0^{-1} R(u) \f$ of a frozen
+/// Jacobian \f$ J_0 \f$, the accelerated step is
+/// \f[ s_k = \beta f_k - (\Delta S + \beta \Delta F) \gamma, \f]
+/// where the columns of \f$ \Delta F \f$ and \f$ \Delta S \f$ are the
+/// differences of the last few fixed point residuals and the last few
+/// steps, and \f$ \gamma \f$ minimizes
+/// \f$ \| f_k - \Delta F \gamma \| \f$. The small least squares
+/// problem is solved through its normal equations. Without a history,
+/// or if the normal equations are singular, this is the damped fixed
+/// point step \f$ s_k = \beta f_k \f$.
+class Anderson {
+
+  public:
+
+    /// @brief Construct the accelerator.
+    /// @param map The owned DOF map.
+    /// @param window The maximum number of kept differences.
+    /// @param mixing The mixing parameter \f$ \beta \f$.
+    Anderson(Teuchos::RCP<const Map> map, int window, double mixing);
+
+    /// @brief Discard the history.
+    /// @details Call this whenever the frozen Jacobian is reassembled,
+    /// since the fixed point map changes with it.
+    void reset();
+
+    /// @brief Compute the accelerated step.
+    /// @param f The fixed point residual at the current iterate.
+    /// @param s The step to the next iterate, filled by this method.
+    void compute_step(
+        Teuchos::RCP<goal::Vector> f,
+        Teuchos::RCP<goal::Vector> s);
+
+    /// @brief Returns the number of kept differences.
+    int get_depth() { return int(dF.size()); }
+
+  private:
+
+    bool solve_least_squares(
+        Teuchos::RCP<goal::Vector> f,
+        std::vector<double>& gamma);
+
+    Teuchos::RCP<const Map> map;
+    int window;
+    double mixing;
+    Teuchos::RCP<goal::Vector> f_old;
+    Teuchos::RCP<goal::Vector> s_old;
+    std::deque<Teuchos::RCP<goal::Vector> > dF;
+    std::deque<Teuchos::RCP<goal::Vector> > dS;
+};
+
+/// @brief Create an Anderson accelerator.
+/// @param map The owned DOF map.
+/// @param window The maximum number of kept differences.
+/// @param mixing The mixing parameter.
+Anderson* create_anderson(
+    Teuchos::RCP<const Map> map, int window, double mixing);
+
+/// @brief Destroy an Anderson accelerator.
+/// @param a The \ref ml::Anderson object to destroy.
+void destroy_anderson(Anderson* a);
+
+} // end namespace ml
+
+#endif
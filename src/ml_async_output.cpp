@@ -0,0 +1,281 @@
+#include <fstream>
+#include <unordered_map>
+#include <apf.h>
+#include <apfMesh.h>
+#include <apfShape.h>
+#include <goal_control.hpp>
+#include <goal_discretization.hpp>
+#include <PCU.h>
+
+#include "ml_async_output.hpp"
+
+namespace ml {
+
+struct SnapshotField {
+  std::string name;
+  int num_comps;
+  bool is_cell;
+  std::vector<double> data;
+};
+
+struct Snapshot {
+  int step;
+  double time;
+  std::vector<double> points;
+  std::vector<int> connectivity;
+  std::vector<int> offsets;
+  std::vector<unsigned char> types;
+  std::vector<SnapshotField> fields;
+  size_t get_bytes() const {
+    size_t bytes = points.size() * sizeof(double);
+    bytes += (connectivity.size() + offsets.size()) * sizeof(int);
+    bytes += types.size();
+    for (size_t i = 0; i < fields.size(); ++i)
+      bytes += fields[i].data.size() * sizeof(double);
+    return bytes;
+  }
+};
+
+static ParameterList get_valid_params() {
+  ParameterList p;
+  p.set<std::string>("file", "");
+  p.set<int>("interval", 0);
+  p.set<Teuchos::Array<std::string> >("fields", {});
+  p.set<double>("buffer size", 0.0);
+  return p;
+}
+
+static void validate_params(ParameterList const& p) {
+  GOAL_ALWAYS_ASSERT(p.isType<std::string>("file"));
+  GOAL_ALWAYS_ASSERT(p.isType<Teuchos::Array<std::string> >("fields"));
+  p.validateParameters(get_valid_params(), 0);
+}
+
+static unsigned char get_vtk_type(int apf_type) {
+  switch (apf_type) {
+    case apf::Mesh::EDGE: return 3;
+    case apf::Mesh::TRIANGLE: return 5;
+    case apf::Mesh::QUAD: return 9;
+    case apf::Mesh::TET: return 10;
+    case apf::Mesh::HEX: return 12;
+    case apf::Mesh::PRISM: return 13;
+    case apf::Mesh::PYRAMID: return 14;
+    default: goal::fail("unsupported vtk element type");
+  }
+  return 0;
+}
+
+AsyncOutput::AsyncOutput(ParameterList const& p, goal::Discretization* d)
+    : disc(d),
+      buffered_bytes(0),
+      is_done(false) {
+  validate_params(p);
+  file = p.get<std::string>("file");
+  interval = p.isType<int>("interval") ? p.get<int>("interval") : 1;
+  double mb = p.isType<double>("buffer size") ?
+    p.get<double>("buffer size") : 256.0;
+  max_bytes = (size_t)(mb * 1024.0 * 1024.0);
+  auto f = p.get<Teuchos::Array<std::string> >("fields");
+  fields.assign(f.begin(), f.end());
+  GOAL_ALWAYS_ASSERT(interval > 0);
+  writer = std::thread(&AsyncOutput::run_writer, this);
+}
+
+AsyncOutput::~AsyncOutput() {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    is_done = true;
+  }
+  cond.notify_all();
+  writer.join();
+}
+
+Snapshot* AsyncOutput::take_snapshot(int step, double t) {
+  auto s = new Snapshot;
+  s->step = step;
+  s->time = t;
+
+  // copy the linear geometry and topology of the local mesh
+  apf::Vector3 x;
+  apf::Downward verts;
+  apf::MeshEntity* ent;
+  int num_verts = 0;
+  std::unordered_map<apf::MeshEntity*, int> vtx_ids;
+  auto mesh = disc->get_apf_mesh();
+  auto dim = mesh->getDimension();
+  auto it = mesh->begin(0);
+  while ((ent = mesh->iterate(it))) {
+    vtx_ids[ent] = num_verts++;
+    mesh->getPoint(ent, 0, x);
+    for (int i = 0; i < 3; ++i)
+      s->points.push_back(x[i]);
+  }
+  mesh->end(it);
+  it = mesh->begin(dim);
+  while ((ent = mesh->iterate(it))) {
+    int num_elem_verts = mesh->getDownward(ent, 0, verts);
+    for (int v = 0; v < num_elem_verts; ++v)
+      s->connectivity.push_back(vtx_ids[verts[v]]);
+    s->offsets.push_back(s->connectivity.size());
+    s->types.push_back(get_vtk_type(mesh->getType(ent)));
+  }
+  mesh->end(it);
+
+  // copy the selected field values at vertices or elements
+  for (size_t i = 0; i < fields.size(); ++i) {
+    auto f = apf::findField(mesh, fields[i].c_str());
+    if (! f) goal::fail("output field %s not found", fields[i].c_str());
+    SnapshotField sf;
+    sf.name = fields[i];
+    sf.num_comps = apf::countComponents(f);
+    sf.is_cell = ! apf::getShape(f)->hasNodesIn(0);
+    std::vector<double> comps(sf.num_comps);
+    it = mesh->begin(sf.is_cell ? dim : 0);
+    while ((ent = mesh->iterate(it))) {
+      apf::getComponents(f, ent, 0, &comps[0]);
+      sf.data.insert(sf.data.end(), comps.begin(), comps.end());
+    }
+    mesh->end(it);
+    s->fields.push_back(sf);
+  }
+
+  return s;
+}
+
+void AsyncOutput::write(int step, double t) {
+  if (step % interval != 0) return;
+  auto t0 = PCU_Time();
+  auto s = take_snapshot(step, t);
+  auto bytes = s->get_bytes();
+  {
+    // apply backpressure while the buffer is full
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [&] {
+      return queue.empty() || (buffered_bytes + bytes <= max_bytes);
+    });
+    queue.push_back(s);
+    buffered_bytes += bytes;
+  }
+  cond.notify_all();
+  auto t1 = PCU_Time();
+  goal::print(" > output step %d buffered in %f seconds", step, t1 - t0);
+}
+
+void AsyncOutput::run_writer() {
+  while (true) {
+    Snapshot* s = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond.wait(lock, [&] { return is_done || (! queue.empty()); });
+      if (queue.empty()) break;
+      s = queue.front();
+      queue.pop_front();
+    }
+    write_snapshot(s);
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      buffered_bytes -= s->get_bytes();
+    }
+    cond.notify_all();
+    delete s;
+  }
+}
+
+template <typename T>
+static void write_array(
+    std::ostream& os,
+    std::string const& type,
+    std::string const& name,
+    int num_comps,
+    std::vector<T> const& data) {
+  os << "<DataArray type=\"" << type << "\" Name=\"" << name << "\"";
+  os << " NumberOfComponents=\"" << num_comps << "\" format=\"ascii\">\n";
+  for (size_t i = 0; i < data.size(); ++i)
+    os << +data[i] << ((i + 1) % num_comps ? " " : "\n");
+  os << "</DataArray>\n";
+}
+
+static std::string get_piece_name(std::string const& name, int rank) {
+  return name + "_" + std::to_string(rank) + ".vtu";
+}
+
+void AsyncOutput::write_snapshot(Snapshot* s) {
+  auto rank = PCU_Comm_Self();
+  auto name = file + "_" + std::to_string(s->step);
+  int num_points = s->points.size() / 3;
+  int num_cells = s->types.size();
+
+  // write this rank's piece
+  std::ofstream vtu(get_piece_name(name, rank).c_str());
+  vtu << std::scientific;
+  vtu.precision(15);
+  vtu << "<VTKFile type=\"UnstructuredGrid\">\n<UnstructuredGrid>\n";
+  vtu << "<Piece NumberOfPoints=\"" << num_points << "\"";
+  vtu << " NumberOfCells=\"" << num_cells << "\">\n";
+  vtu << "<Points>\n";
+  write_array(vtu, "Float64", "coordinates", 3, s->points);
+  vtu << "</Points>\n<Cells>\n";
+  write_array(vtu, "Int32", "connectivity", 1, s->connectivity);
+  write_array(vtu, "Int32", "offsets", 1, s->offsets);
+  write_array(vtu, "UInt8", "types", 1, s->types);
+  vtu << "</Cells>\n<PointData>\n";
+  for (size_t i = 0; i < s->fields.size(); ++i) {
+    auto& f = s->fields[i];
+    if (! f.is_cell) write_array(vtu, "Float64", f.name, f.num_comps, f.data);
+  }
+  vtu << "</PointData>\n<CellData>\n";
+  for (size_t i = 0; i < s->fields.size(); ++i) {
+    auto& f = s->fields[i];
+    if (f.is_cell) write_array(vtu, "Float64", f.name, f.num_comps, f.data);
+  }
+  vtu << "</CellData>\n</Piece>\n</UnstructuredGrid>\n</VTKFile>\n";
+  vtu.close();
+
+  if (rank) return;
+
+  // write the parallel index for this step
+  auto field_type = [] (SnapshotField const& f) {
+    return "<PDataArray type=\"Float64\" Name=\"" + f.name +
+      "\" NumberOfComponents=\"" + std::to_string(f.num_comps) + "\"/>\n";
+  };
+  std::ofstream pvtu((name + ".pvtu").c_str());
+  pvtu << "<VTKFile type=\"PUnstructuredGrid\">\n";
+  pvtu << "<PUnstructuredGrid GhostLevel=\"0\">\n";
+  pvtu << "<PPoints>\n<PDataArray type=\"Float64\" ";
+  pvtu << "NumberOfComponents=\"3\"/>\n</PPoints>\n<PPointData>\n";
+  for (size_t i = 0; i < s->fields.size(); ++i)
+    if (! s->fields[i].is_cell) pvtu << field_type(s->fields[i]);
+  pvtu << "</PPointData>\n<PCellData>\n";
+  for (size_t i = 0; i < s->fields.size(); ++i)
+    if (s->fields[i].is_cell) pvtu << field_type(s->fields[i]);
+  pvtu << "</PCellData>\n";
+  for (int r = 0; r < PCU_Comm_Peers(); ++r)
+    pvtu << "<Piece Source=\"" << get_piece_name(name, r) << "\"/>\n";
+  pvtu << "</PUnstructuredGrid>\n</VTKFile>\n";
+  pvtu.close();
+
+  written.push_back(std::make_pair(s->time, name + ".pvtu"));
+  write_collection();
+}
+
+void AsyncOutput::write_collection() {
+  std::ofstream pvd((file + ".pvd").c_str());
+  pvd << "<VTKFile type=\"Collection\">\n<Collection>\n";
+  for (size_t i = 0; i < written.size(); ++i) {
+    pvd << "<DataSet timestep=\"" << written[i].first << "\" part=\"0\"";
+    pvd << " file=\"" << written[i].second << "\"/>\n";
+  }
+  pvd << "</Collection>\n</VTKFile>\n";
+  pvd.close();
+}
+
+AsyncOutput* create_async_output(
+    ParameterList const& p, goal::Discretization* d) {
+  return new AsyncOutput(p, d);
+}
+
+void destroy_async_output(AsyncOutput* o) {
+  delete o;
+}
+
+} // end namespace ml
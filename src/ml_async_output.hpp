@@ -0,0 +1,87 @@
+#ifndef ml_async_output_hpp
+#define ml_async_output_hpp
+
+/// @file ml_async_output.hpp
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <Teuchos_ParameterList.hpp>
+
+/// @cond
+namespace goal {
+class Discretization;
+}
+/// @endcond
+
+namespace ml {
+
+using Teuchos::ParameterList;
+
+/// @cond
+struct Snapshot;
+/// @endcond
+
+/// @brief Asynchronous time-series output.
+/// @details At every output interval, the selected fields are copied into
+/// a snapshot buffer on the calling thread. A dedicated writer thread
+/// serializes buffered snapshots to per-rank VTK unstructured grid files
+/// while the solver continues. If the buffered snapshots exceed the
+/// memory limit, the calling thread blocks until the writer catches up.
+/// A ParaView collection (.pvd) indexes the written steps by time.
+class AsyncOutput {
+
+  public:
+
+    /// @brief Construct the asynchronous output object.
+    /// @param p The time series parameter list.
+    /// @param d The relevant discretization object.
+    /// @details This starts the writer thread.
+    AsyncOutput(ParameterList const& p, goal::Discretization* d);
+
+    /// @brief Destroy the asynchronous output object.
+    /// @details This flushes all buffered snapshots, joins the writer
+    /// thread and writes the time series collection file.
+    ~AsyncOutput();
+
+    /// @brief Snapshot the selected fields if this is an output step.
+    /// @param step The current solver step.
+    /// @param t The current time.
+    void write(int step, double t);
+
+  private:
+
+    Snapshot* take_snapshot(int step, double t);
+    void run_writer();
+    void write_snapshot(Snapshot* s);
+    void write_collection();
+
+    goal::Discretization* disc;
+    std::string file;
+    int interval;
+    size_t max_bytes;
+    std::vector<std::string> fields;
+
+    size_t buffered_bytes;
+    bool is_done;
+    std::deque<Snapshot*> queue;
+    std::vector<std::pair<double, std::string> > written;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::thread writer;
+};
+
+/// @brief Create an asynchronous output object.
+/// @param p The time series parameter list.
+/// @param d The relevant discretization object.
+AsyncOutput* create_async_output(
+    ParameterList const& p, goal::Discretization* d);
+
+/// @brief Destroy an asynchronous output object.
+/// @param o The \ref ml::AsyncOutput object to destroy.
+void destroy_async_output(AsyncOutput* o);
+
+} // end namespace ml
+
+#endif
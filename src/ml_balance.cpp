@@ -0,0 +1,200 @@
+#include <apf.h>
+#include <apfMesh2.h>
+#include <apfZoltan.h>
+#include <goal_control.hpp>
+#include <goal_discretization.hpp>
+#include <goal_states.hpp>
+#include <MiniTensor.h>
+#include <PCU.h>
+
+#include "ml_balance.hpp"
+#include "ml_mechanics.hpp"
+
+namespace ml {
+
+static ParameterList get_valid_params() {
+  ParameterList p;
+  p.set<int>("interval", 0);
+  p.set<double>("plastic weight", 0.0);
+  p.set<double>("tolerance", 0.0);
+  return p;
+}
+
+static double get_double(
+    ParameterList const& p, const char* name, double value) {
+  return p.isType<double>(name) ? p.get<double>(name) : value;
+}
+
+static int count_ips(Mechanics* m, apf::Mesh* mesh) {
+  int num_ips = 0;
+  apf::MeshEntity* elem;
+  auto it = mesh->begin(mesh->getDimension());
+  if ((elem = mesh->iterate(it))) {
+    auto me = apf::createMeshElement(mesh, elem);
+    num_ips = apf::countIntPoints(me, m->get_q_degree());
+    apf::destroyMeshElement(me);
+  }
+  mesh->end(it);
+  return PCU_Max_Int(num_ips);
+}
+
+void mark_yielding(Mechanics* m, goal::Discretization* d) {
+  if (! m->has_history()) return;
+  double eqps;
+  double eqps_old;
+  auto mesh = d->get_apf_mesh();
+  int num_ips = count_ips(m, mesh);
+  auto tag = mesh->findTag("ml_yielding");
+  if (! tag) tag = mesh->createIntTag("ml_yielding", 1);
+  auto states = m->get_states();
+  apf::MeshEntity* elem;
+  auto it = mesh->begin(mesh->getDimension());
+  while ((elem = mesh->iterate(it))) {
+    int num_yielding = 0;
+    for (int ip = 0; ip < num_ips; ++ip) {
+      states->get_scalar("eqps", elem, ip, eqps);
+      states->get_scalar("eqps_old", elem, ip, eqps_old);
+      if (eqps > eqps_old) ++num_yielding;
+    }
+    mesh->setIntTag(elem, tag, &num_yielding);
+  }
+  mesh->end(it);
+}
+
+static double get_weights(
+    apf::Mesh* mesh, int num_ips, double plastic_weight,
+    apf::MeshTag* weights) {
+  double cost = 0.0;
+  auto yielding = mesh->findTag("ml_yielding");
+  apf::MeshEntity* elem;
+  auto it = mesh->begin(mesh->getDimension());
+  while ((elem = mesh->iterate(it))) {
+    int num_yielding = 0;
+    if (yielding && mesh->hasTag(elem, yielding))
+      mesh->getIntTag(elem, yielding, &num_yielding);
+    double w = num_ips + num_yielding * (plastic_weight - 1.0);
+    mesh->setDoubleTag(elem, weights, &w);
+    cost += w;
+  }
+  mesh->end(it);
+  return cost;
+}
+
+static void pack_history(
+    Mechanics* m, apf::Mesh* mesh, int num_ips, apf::MeshTag* history) {
+  int dim = mesh->getDimension();
+  int stride = 1 + dim * dim;
+  auto states = m->get_states();
+  double eqps;
+  minitensor::Tensor<double> Fp(dim);
+  std::vector<double> data(num_ips * stride);
+  apf::MeshEntity* elem;
+  auto it = mesh->begin(dim);
+  while ((elem = mesh->iterate(it))) {
+    for (int ip = 0; ip < num_ips; ++ip) {
+      states->get_scalar("eqps_old", elem, ip, eqps);
+      states->get_tensor("Fp_old", elem, ip, Fp);
+      data[ip * stride] = eqps;
+      for (int i = 0; i < dim; ++i)
+      for (int j = 0; j < dim; ++j)
+        data[ip * stride + 1 + i * dim + j] = Fp(i, j);
+    }
+    mesh->setDoubleTag(elem, history, &data[0]);
+  }
+  mesh->end(it);
+}
+
+static void unpack_history(
+    Mechanics* m, apf::Mesh* mesh, int num_ips, apf::MeshTag* history) {
+  int dim = mesh->getDimension();
+  int stride = 1 + dim * dim;
+  auto states = m->get_states();
+  minitensor::Tensor<double> Fp(dim);
+  std::vector<double> data(num_ips * stride);
+  apf::MeshEntity* elem;
+  auto it = mesh->begin(dim);
+  while ((elem = mesh->iterate(it))) {
+    mesh->getDoubleTag(elem, history, &data[0]);
+    for (int ip = 0; ip < num_ips; ++ip) {
+      double eqps = data[ip * stride];
+      for (int i = 0; i < dim; ++i)
+      for (int j = 0; j < dim; ++j)
+        Fp(i, j) = data[ip * stride + 1 + i * dim + j];
+      states->set_scalar("eqps", elem, ip, eqps);
+      states->set_scalar("eqps_old", elem, ip, eqps);
+      states->set_tensor("Fp", elem, ip, Fp);
+      states->set_tensor("Fp_old", elem, ip, Fp);
+    }
+  }
+  mesh->end(it);
+}
+
+static void destroy_tag(apf::Mesh* mesh, apf::MeshTag* tag) {
+  apf::removeTagFromDimension(mesh, tag, mesh->getDimension());
+  mesh->destroyTag(tag);
+}
+
+static double get_imbalance(double cost) {
+  double max_cost = cost;
+  PCU_Add_Doubles(&cost, 1);
+  PCU_Max_Doubles(&max_cost, 1);
+  return max_cost / (cost / PCU_Comm_Peers());
+}
+
+bool needs_rebalance(
+    ParameterList const& p, Mechanics* m, goal::Discretization* d) {
+  p.validateParameters(get_valid_params(), 0);
+  auto plastic_weight = get_double(p, "plastic weight", 4.0);
+  auto tolerance = get_double(p, "tolerance", 1.05);
+  auto mesh = d->get_apf_mesh();
+  int num_ips = count_ips(m, mesh);
+  auto weights = mesh->createDoubleTag("ml_cost", 1);
+  double cost = get_weights(mesh, num_ips, plastic_weight, weights);
+  destroy_tag(mesh, weights);
+  double imbalance = get_imbalance(cost);
+  goal::print(" > cost imbalance: %f", imbalance);
+  return imbalance > tolerance;
+}
+
+void rebalance(
+    ParameterList const& p, Mechanics* m, goal::Discretization* d) {
+
+  auto t0 = PCU_Time();
+  auto plastic_weight = get_double(p, "plastic weight", 4.0);
+  auto tolerance = get_double(p, "tolerance", 1.05);
+  auto mesh = d->get_apf_mesh();
+  int dim = mesh->getDimension();
+  int num_ips = count_ips(m, mesh);
+  auto weights = mesh->createDoubleTag("ml_cost", 1);
+  get_weights(mesh, num_ips, plastic_weight, weights);
+
+  // element tags move with the elements, the states do not
+  apf::MeshTag* history = 0;
+  if (m->has_history()) {
+    history = mesh->createDoubleTag("ml_history", num_ips * (1 + dim * dim));
+    pack_history(m, mesh, num_ips, history);
+  }
+  m->pre_adapt();
+
+  // repartition with the cost weights
+  auto balancer = apf::makeZoltanBalancer(
+      mesh, apf::GRAPH, apf::REPARTITION, false);
+  balancer->balance(weights, tolerance);
+  delete balancer;
+
+  // rebuild the discretization and the mechanics data
+  d->update();
+  m->post_adapt();
+  if (history) {
+    unpack_history(m, mesh, num_ips, history);
+    destroy_tag(mesh, history);
+  }
+  double cost = get_weights(mesh, num_ips, plastic_weight, weights);
+  destroy_tag(mesh, weights);
+
+  auto t1 = PCU_Time();
+  goal::print(" > cost imbalance after rebalance: %f", get_imbalance(cost));
+  goal::print(" > mesh rebalanced in %f seconds", t1 - t0);
+}
+
+} // end namespace ml
@@ -0,0 +1,58 @@
+#ifndef ml_balance_hpp
+#define ml_balance_hpp
+
+/// @file ml_balance.hpp
+
+#include <Teuchos_ParameterList.hpp>
+
+/// @cond
+namespace goal {
+class Discretization;
+}
+/// @endcond
+
+namespace ml {
+
+using Teuchos::ParameterList;
+
+/// @cond
+class Mechanics;
+/// @endcond
+
+/// @brief Mark the integration points that yielded in the last step.
+/// @param m The mechanics object.
+/// @param d The relevant discretization object.
+/// @details The number of points of each element whose equivalent
+/// plastic strain grew over the step is stored in an element tag that
+/// migrates with the element. Call this after a converged step and
+/// before \ref ml::Mechanics::update_history.
+void mark_yielding(Mechanics* m, goal::Discretization* d);
+
+/// @brief Returns true if the integration point cost is imbalanced.
+/// @param p The rebalance parameter list.
+/// @param m The mechanics object.
+/// @param d The relevant discretization object.
+/// @details Each element is weighted by its number of integration
+/// points, where a point that yielded in the last step, as marked by
+/// \ref ml::mark_yielding, counts `plastic weight` times (default 4)
+/// an elastic one, to account for the return mapping. Points that
+/// yielded earlier and now unload elastically count as elastic. The
+/// cost is imbalanced if the maximum rank cost exceeds the mean by more
+/// than the `tolerance` (default 1.05).
+bool needs_rebalance(
+    ParameterList const& p, Mechanics* m, goal::Discretization* d);
+
+/// @brief Repartition the mesh by the cost of its integration points.
+/// @param p The rebalance parameter list.
+/// @param m The mechanics object.
+/// @param d The relevant discretization object.
+/// @details The mesh is repartitioned by Zoltan with the element cost
+/// weights of \ref ml::needs_rebalance. The history states are carried
+/// through the migration exactly in element tags, and the displacement
+/// fields migrate with the mesh. The primal data built on the old
+/// partition must be destroyed before calling this.
+void rebalance(ParameterList const& p, Mechanics* m, goal::Discretization* d);
+
+} // end namespace ml
+
+#endif
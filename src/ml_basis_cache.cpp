@@ -0,0 +1,39 @@
+#include "ml_basis_cache.hpp"
+
+namespace ml {
+
+BasisCache::BasisCache(size_t max)
+    : max_bytes(max),
+      bytes(0) {
+}
+
+BasisCache::Block const* BasisCache::find(
+    int set, int size, apf::MeshEntity* first) {
+  auto it = blocks.find(Key(set, size, first));
+  if (it == blocks.end()) return 0;
+  return &(it->second);
+}
+
+bool BasisCache::insert(
+    int set, int size, apf::MeshEntity* first, Block const& b) {
+  auto b_bytes = (b.grad_w.size() + b.dv.size()) * sizeof(double);
+  if (bytes + b_bytes > max_bytes) return false;
+  blocks[Key(set, size, first)] = b;
+  bytes += b_bytes;
+  return true;
+}
+
+void BasisCache::clear() {
+  blocks.clear();
+  bytes = 0;
+}
+
+BasisCache* create_basis_cache(size_t max_bytes) {
+  return new BasisCache(max_bytes);
+}
+
+void destroy_basis_cache(BasisCache* c) {
+  delete c;
+}
+
+} // end namespace ml
@@ -0,0 +1,86 @@
+#ifndef ml_basis_cache_hpp
+#define ml_basis_cache_hpp
+
+/// @file ml_basis_cache.hpp
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+/// @cond
+namespace apf {
+class MeshEntity;
+}
+/// @endcond
+
+namespace ml {
+
+/// @brief Storage for reference configuration basis data.
+/// @details In the total Lagrangian formulation the basis gradients and
+/// the integration weights depend only on the reference mesh, so they
+/// are kept per workset by the \ref ml::CachedBasis evaluators and
+/// reused by every later residual and Jacobian evaluation. A workset is
+/// identified by its entity set, its size and its first entity. The
+/// cache must be cleared whenever the mesh changes.
+class BasisCache {
+
+  public:
+
+    /// @brief The basis data of one workset.
+    /// @details For p1 fields on affine simplices the gradients and the
+    /// differential volume are constant in each element and are stored
+    /// once per element. Otherwise, as for p2 and higher fields or
+    /// curved elements, they are stored per integration point.
+    struct Block {
+      /// @brief The basis gradients.
+      std::vector<double> grad_w;
+      /// @brief The differential volumes.
+      std::vector<double> dv;
+    };
+
+    /// @brief Construct the cache.
+    /// @param max_bytes The memory cap for the stored blocks.
+    BasisCache(size_t max_bytes);
+
+    /// @brief Find the block of a workset.
+    /// @param set The entity set the workset belongs to.
+    /// @param size The number of entities in the workset.
+    /// @param first The first entity of the workset.
+    /// @returns The block, or null if it is not stored.
+    Block const* find(int set, int size, apf::MeshEntity* first);
+
+    /// @brief Store the block of a workset.
+    /// @param set The entity set the workset belongs to.
+    /// @param size The number of entities in the workset.
+    /// @param first The first entity of the workset.
+    /// @param b The block to store.
+    /// @returns False if the block would exceed the memory cap, in which
+    /// case the workset is recomputed on every evaluation.
+    bool insert(int set, int size, apf::MeshEntity* first, Block const& b);
+
+    /// @brief Drop all stored blocks.
+    void clear();
+
+    /// @brief Returns the bytes of the stored blocks.
+    size_t get_bytes() { return bytes; }
+
+  private:
+
+    using Key = std::tuple<int, int, apf::MeshEntity*>;
+
+    size_t max_bytes;
+    size_t bytes;
+    std::map<Key, Block> blocks;
+};
+
+/// @brief Create a basis cache.
+/// @param max_bytes The memory cap for the stored blocks.
+BasisCache* create_basis_cache(size_t max_bytes);
+
+/// @brief Destroy a basis cache.
+/// @param c The \ref ml::BasisCache object to destroy.
+void destroy_basis_cache(BasisCache* c);
+
+} // end namespace ml
+
+#endif
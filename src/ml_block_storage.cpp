@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <goal_control.hpp>
+#include <PCU.h>
+#include <Tpetra_BlockCrsMatrix_Helpers.hpp>
+
+#include "ml_block_storage.hpp"
+
+namespace ml {
+
+using Import = Tpetra::Import<goal::LO, goal::GO, goal::KNode>;
+
+NodeBlockOperator::NodeBlockOperator(
+    Teuchos::RCP<goal::Matrix> A_in,
+    Teuchos::RCP<goal::Vector> ids,
+    int dim,
+    bool symmetric)
+    : A(A_in),
+      is_symmetric(symmetric),
+      block_size(dim) {
+
+  // the node-blocked map permutes the rank-local dofs
+  auto row_map = A->getRowMap();
+  size_t n = row_map->getNodeNumElements();
+  auto id = ids->getData();
+  std::vector<std::pair<goal::GO, goal::LO> > order(n);
+  for (size_t i = 0; i < n; ++i)
+    order[i] = std::make_pair(goal::GO(id[i]), goal::LO(i));
+  std::sort(order.begin(), order.end());
+  perm.resize(n);
+  Teuchos::Array<goal::GO> gids(n);
+  for (size_t k = 0; k < n; ++k) {
+    gids[k] = order[k].first;
+    perm[order[k].second] = k;
+  }
+  auto invalid = Teuchos::OrdinalTraits<Tpetra::global_size_t>::invalid();
+  block_map = Teuchos::rcp(new Map(invalid, gids(), 0, row_map->getComm()));
+
+  // find the node-blocked ids and dirichlet flags of the columns
+  auto col_map = A->getColMap();
+  auto dbc_rows = get_dbc_rows(A);
+  goal::Vector col_ids(col_map);
+  goal::Vector col_dbc(col_map);
+  Import importer(A->getDomainMap(), col_map);
+  col_ids.doImport(*ids, importer, Tpetra::INSERT);
+  col_dbc.doImport(*dbc_rows, importer, Tpetra::INSERT);
+  auto cid = col_ids.getData();
+  auto cdbc = col_dbc.getData();
+  auto is_dbc = dbc_rows->getData();
+
+  // copy the renumbered entries. symmetric storage keeps the upper
+  // triangle and drops the coupling to dirichlet dofs.
+  size_t num = 0;
+  size_t max = A->getNodeMaxNumRowEntries();
+  Teuchos::Array<goal::LO> cols(max);
+  Teuchos::Array<goal::GO> block_cols(max);
+  Teuchos::Array<goal::ST> vals(max);
+  auto Ab = Teuchos::rcp(new goal::Matrix(block_map, max));
+  if (is_symmetric) D = Teuchos::rcp(new goal::Vector(block_map));
+  for (size_t row = 0; row < n; ++row) {
+    A->getLocalRowCopy(row, cols(), vals(), num);
+    auto block_row = gids[perm[row]];
+    size_t k = 0;
+    for (size_t j = 0; j < num; ++j) {
+      auto block_col = goal::GO(cid[cols[j]]);
+      bool is_diag = (block_col == block_row);
+      if (is_symmetric) {
+        if (block_col < block_row) continue;
+        if ((! is_diag) && (is_dbc[row] != 0.0 || cdbc[cols[j]] != 0.0))
+          continue;
+        if (is_diag) D->replaceLocalValue(perm[row], vals[j]);
+      }
+      block_cols[k] = block_col;
+      vals[k] = vals[j];
+      ++k;
+    }
+    Ab->insertGlobalValues(block_row, block_cols(0, k), vals(0, k));
+  }
+  Ab->fillComplete(block_map, block_map);
+  if (is_symmetric) U = Ab;
+  else B = Tpetra::convertToBlockCrsMatrix(*Ab, block_size);
+}
+
+Teuchos::RCP<const Map> NodeBlockOperator::getDomainMap() const {
+  return A->getDomainMap();
+}
+
+Teuchos::RCP<const Map> NodeBlockOperator::getRangeMap() const {
+  return A->getRangeMap();
+}
+
+void NodeBlockOperator::permute(
+    MultiVector const& X, MultiVector& Xb_out) const {
+  for (size_t j = 0; j < X.getNumVectors(); ++j) {
+    auto x = X.getData(j);
+    auto xb = Xb_out.getDataNonConst(j);
+    for (size_t i = 0; i < perm.size(); ++i)
+      xb[perm[i]] = x[i];
+  }
+}
+
+void NodeBlockOperator::unpermute(
+    MultiVector const& Yb_in, MultiVector& Y,
+    goal::ST alpha, goal::ST beta) const {
+  for (size_t j = 0; j < Y.getNumVectors(); ++j) {
+    auto yb = Yb_in.getData(j);
+    auto y = Y.getDataNonConst(j);
+    for (size_t i = 0; i < perm.size(); ++i) {
+      if (beta == 0.0) y[i] = alpha * yb[perm[i]];
+      else y[i] = beta * y[i] + alpha * yb[perm[i]];
+    }
+  }
+}
+
+void NodeBlockOperator::apply_blocked(
+    MultiVector const& X, MultiVector& Y) const {
+  if (Teuchos::nonnull(B)) {
+    B->apply(X, Y);
+    return;
+  }
+  U->apply(X, Y);
+  U->apply(X, Y, Teuchos::TRANS, 1.0, 1.0);
+  for (size_t j = 0; j < X.getNumVectors(); ++j)
+    Y.getVectorNonConst(j)->elementWiseMultiply(
+        -1.0, *D, *X.getVector(j), 1.0);
+}
+
+void NodeBlockOperator::apply(
+    MultiVector const& X,
+    MultiVector& Y,
+    Teuchos::ETransp mode,
+    goal::ST alpha,
+    goal::ST beta) const {
+  GOAL_DEBUG_ASSERT(mode == Teuchos::NO_TRANS);
+  (void)mode;
+  auto n = X.getNumVectors();
+  if (Xb.is_null() || Xb->getNumVectors() != n) {
+    Xb = Teuchos::rcp(new MultiVector(block_map, n));
+    Yb = Teuchos::rcp(new MultiVector(block_map, n));
+  }
+  permute(X, *Xb);
+  apply_blocked(*Xb, *Yb);
+  unpermute(*Yb, Y, alpha, beta);
+}
+
+void NodeBlockOperator::report(int num_applies) const {
+
+  // time the applications of both layouts
+  MultiVector x(A->getDomainMap(), 1);
+  MultiVector y(A->getRangeMap(), 1);
+  x.putScalar(1.0);
+  auto t0 = PCU_Time();
+  for (int i = 0; i < num_applies; ++i) A->apply(x, y);
+  auto t1 = PCU_Time();
+  for (int i = 0; i < num_applies; ++i) apply(x, y);
+  auto t2 = PCU_Time();
+
+  // count the bytes of values, column indices and row offsets
+  long sizes[2];
+  long rows = A->getNodeNumRows();
+  long offsets = (rows + 1) * sizeof(size_t);
+  long entry = sizeof(goal::ST) + sizeof(goal::LO);
+  sizes[0] = A->getNodeNumEntries() * entry + offsets;
+  if (is_symmetric) {
+    sizes[1] = U->getNodeNumEntries() * entry + offsets;
+    sizes[1] += rows * sizeof(goal::ST);
+  } else {
+    long bs2 = block_size * block_size;
+    long blocks = B->getCrsGraph().getNodeNumEntries();
+    long block_rows = rows / block_size;
+    sizes[1] = blocks * (bs2 * sizeof(goal::ST) + sizeof(goal::LO));
+    sizes[1] += (block_rows + 1) * sizeof(size_t);
+  }
+  PCU_Add_Longs(sizes, 2);
+  auto name = is_symmetric ? "symmetric" : "bsr";
+  goal::print(" > crs matrix: %ld bytes, %d applies in %f seconds",
+      sizes[0], num_applies, t1 - t0);
+  goal::print(" > %s copy: %ld bytes, %d applies in %f seconds",
+      name, sizes[1], num_applies, t2 - t1);
+  goal::print(" > crs and %s copy: %ld bytes in total",
+      name, sizes[0] + sizes[1]);
+}
+
+} // end namespace ml
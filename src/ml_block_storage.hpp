@@ -0,0 +1,89 @@
+#ifndef ml_block_storage_hpp
+#define ml_block_storage_hpp
+
+/// @file ml_block_storage.hpp
+
+#include <Tpetra_BlockCrsMatrix.hpp>
+#include "ml_linear_algebra.hpp"
+
+namespace ml {
+
+/// @brief A copy of the Jacobian in node-blocked storage.
+/// @details The DOFs are renumbered node by node with the ids of
+/// \ref ml::build_node_block_ids, which only permutes the rank-local
+/// DOFs, and the renumbered matrix is stored either as a block CRS
+/// matrix with \f$ d \times d \f$ node blocks, which stores one column
+/// index per block, or symmetrically as its upper triangle \f$ U \f$
+/// and diagonal \f$ D \f$, applied as \f$ U x + U^T x - D x \f$. Each
+/// application permutes the vectors to and from the node-blocked
+/// ordering, so the operator acts on the ordering of the Jacobian.
+/// The copy lives alongside the assembled CRS Jacobian, so the total
+/// matrix memory is the sum of both, as \ref ml::NodeBlockOperator::report
+/// prints.
+///
+/// Symmetric storage requires a symmetric Jacobian, such as the small
+/// strain elastic one, and the static solvers reject it for any other
+/// model. The Dirichlet rows of the Jacobian are identity
+/// rows whose columns are not zeroed, so the mirrored operator matches
+/// it only when the Dirichlet entries of the right hand side vanish, as
+/// they do for Newton updates.
+class NodeBlockOperator : public Operator {
+
+  public:
+
+    /// @brief Build the node-blocked copy.
+    /// @param A The fill complete Jacobian.
+    /// @param ids The node-blocked ids on the row map of A.
+    /// @param dim The number of DOFs per node.
+    /// @param symmetric Whether to use symmetric storage.
+    NodeBlockOperator(
+        Teuchos::RCP<goal::Matrix> A,
+        Teuchos::RCP<goal::Vector> ids,
+        int dim,
+        bool symmetric);
+
+    /// @brief Returns the domain map of the Jacobian.
+    Teuchos::RCP<const Map> getDomainMap() const;
+
+    /// @brief Returns the range map of the Jacobian.
+    Teuchos::RCP<const Map> getRangeMap() const;
+
+    /// @brief Apply the operator: \f$ Y = \beta Y + \alpha A X \f$.
+    void apply(
+        MultiVector const& X,
+        MultiVector& Y,
+        Teuchos::ETransp mode = Teuchos::NO_TRANS,
+        goal::ST alpha = Teuchos::ScalarTraits<goal::ST>::one(),
+        goal::ST beta = Teuchos::ScalarTraits<goal::ST>::zero()) const;
+
+    /// @brief Print the storage and the apply time against A.
+    /// @param num_applies The number of applications to time.
+    void report(int num_applies = 10) const;
+
+  private:
+
+    using BlockMatrix =
+      Tpetra::BlockCrsMatrix<goal::ST, goal::LO, goal::GO, goal::KNode>;
+
+    void permute(MultiVector const& X, MultiVector& Xb) const;
+    void unpermute(
+        MultiVector const& Yb, MultiVector& Y,
+        goal::ST alpha, goal::ST beta) const;
+    void apply_blocked(MultiVector const& Xb, MultiVector& Yb) const;
+
+    Teuchos::RCP<goal::Matrix> A;
+    bool is_symmetric;
+    int block_size;
+    std::vector<goal::LO> perm;
+    Teuchos::RCP<const Map> block_map;
+    Teuchos::RCP<BlockMatrix> B;
+    Teuchos::RCP<goal::Matrix> U;
+    Teuchos::RCP<goal::Vector> D;
+
+    mutable Teuchos::RCP<MultiVector> Xb;
+    mutable Teuchos::RCP<MultiVector> Yb;
+};
+
+} // end namespace ml
+
+#endif
@@ -0,0 +1,262 @@
+#include <fstream>
+#include <apf.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <goal_control.hpp>
+#include <goal_discretization.hpp>
+#include <goal_field.hpp>
+#include <goal_states.hpp>
+#include <MiniTensor.h>
+#include <PCU.h>
+#include <Teuchos_YamlParameterListHelpers.hpp>
+
+#include "ml_checkpoint.hpp"
+#include "ml_mechanics.hpp"
+
+namespace ml {
+
+static const int magic = 0x4d4c434b;
+static const int version = 2;
+
+struct Header {
+  int magic;
+  int version;
+  int step;
+  long num_field_values;
+  long num_state_values;
+};
+
+static ParameterList get_valid_params() {
+  ParameterList p;
+  p.set<std::string>("file", "");
+  p.set<int>("interval", 0);
+  return p;
+}
+
+static std::string get_name(std::string const& prefix, int step) {
+  return prefix + "_" + std::to_string(step);
+}
+
+static std::string get_rank_file(std::string const& name) {
+  return name + "_" + std::to_string(PCU_Comm_Self()) + ".bin";
+}
+
+template <typename Op>
+static void apply_to_nodes(apf::Field* f, Op const& op) {
+  apf::MeshEntity* ent;
+  auto mesh = apf::getMesh(f);
+  auto shape = apf::getShape(f);
+  for (int d = 0; d <= mesh->getDimension(); ++d) {
+    if (! shape->hasNodesIn(d)) continue;
+    auto it = mesh->begin(d);
+    while ((ent = mesh->iterate(it))) {
+      int num_nodes = shape->countNodesOn(mesh->getType(ent));
+      for (int n = 0; n < num_nodes; ++n)
+        op(ent, n);
+    }
+    mesh->end(it);
+  }
+}
+
+template <typename Op>
+static void apply_to_ips(Mechanics* m, goal::Discretization* d, Op const& op) {
+  apf::MeshEntity* elem;
+  auto mesh = d->get_apf_mesh();
+  auto q_degree = m->get_q_degree();
+  auto it = mesh->begin(mesh->getDimension());
+  while ((elem = mesh->iterate(it))) {
+    auto me = apf::createMeshElement(mesh, elem);
+    int num_ips = apf::countIntPoints(me, q_degree);
+    apf::destroyMeshElement(me);
+    for (int ip = 0; ip < num_ips; ++ip)
+      op(elem, ip);
+  }
+  mesh->end(it);
+}
+
+static std::vector<apf::Field*> get_fields(
+    Mechanics* m, std::vector<apf::Field*> const& nodal) {
+  std::vector<apf::Field*> fields;
+  auto u = m->get_u();
+  for (size_t i = 0; i < u.size(); ++i)
+    fields.push_back(u[i]->get_apf_field());
+  fields.insert(fields.end(), nodal.begin(), nodal.end());
+  return fields;
+}
+
+static std::vector<apf::Field*> create_nodal_fields(Mechanics* m, int n) {
+  std::vector<apf::Field*> nodal;
+  auto u = m->get_u()[0]->get_apf_field();
+  auto mesh = apf::getMesh(u);
+  auto shape = apf::getShape(u);
+  for (int i = 0; i < n; ++i) {
+    auto name = "ml_checkpoint_" + std::to_string(i);
+    nodal.push_back(apf::createField(mesh, name.c_str(), apf::SCALAR, shape));
+  }
+  return nodal;
+}
+
+static void pack_fields(
+    std::vector<apf::Field*> const& fields, std::vector<double>& data) {
+  for (size_t i = 0; i < fields.size(); ++i) {
+    auto f = fields[i];
+    apply_to_nodes(f, [&] (apf::MeshEntity* e, int n) {
+      data.push_back(apf::getScalar(f, e, n));
+    });
+  }
+}
+
+static void unpack_fields(
+    std::vector<apf::Field*> const& fields, std::vector<double> const& data) {
+  size_t offset = 0;
+  for (size_t i = 0; i < fields.size(); ++i) {
+    auto f = fields[i];
+    apply_to_nodes(f, [&] (apf::MeshEntity* e, int n) {
+      apf::setScalar(f, e, n, data[offset++]);
+    });
+  }
+  GOAL_ALWAYS_ASSERT(offset == data.size());
+}
+
+static void pack_states(
+    Mechanics* m, goal::Discretization* d, std::vector<double>& data) {
+  if (! m->has_history()) return;
+  auto states = m->get_states();
+  auto dim = d->get_num_dims();
+  double eqps;
+  minitensor::Tensor<double> Fp(dim);
+  apply_to_ips(m, d, [&] (apf::MeshEntity* e, int ip) {
+    states->get_scalar("eqps_old", e, ip, eqps);
+    states->get_tensor("Fp_old", e, ip, Fp);
+    data.push_back(eqps);
+    for (int i = 0; i < dim; ++i)
+    for (int j = 0; j < dim; ++j)
+      data.push_back(Fp(i, j));
+  });
+}
+
+static void unpack_states(
+    Mechanics* m, goal::Discretization* d, std::vector<double> const& data) {
+  if (! m->has_history()) return;
+  size_t offset = 0;
+  auto states = m->get_states();
+  auto dim = d->get_num_dims();
+  minitensor::Tensor<double> Fp(dim);
+  apply_to_ips(m, d, [&] (apf::MeshEntity* e, int ip) {
+    double eqps = data[offset++];
+    for (int i = 0; i < dim; ++i)
+    for (int j = 0; j < dim; ++j)
+      Fp(i, j) = data[offset++];
+    states->set_scalar("eqps", e, ip, eqps);
+    states->set_scalar("eqps_old", e, ip, eqps);
+    states->set_tensor("Fp", e, ip, Fp);
+    states->set_tensor("Fp_old", e, ip, Fp);
+  });
+  GOAL_ALWAYS_ASSERT(offset == data.size());
+}
+
+void write_checkpoint(
+    ParameterList const& p,
+    int step,
+    Mechanics* m,
+    goal::Discretization* d,
+    bool write_mesh,
+    std::vector<apf::Field*> const& nodal) {
+
+  auto t0 = PCU_Time();
+  p.validateParameters(get_valid_params(), 0);
+  auto name = get_name(p.get<std::string>("file"), step);
+
+  // write the rank-local binary data
+  std::vector<double> fields;
+  std::vector<double> states;
+  pack_fields(get_fields(m, nodal), fields);
+  pack_states(m, d, states);
+  Header header = {magic, version, step, (long)fields.size(),
+    (long)states.size()};
+  std::ofstream file(get_rank_file(name).c_str(), std::ios::binary);
+  if (! file.is_open())
+    goal::fail("could not open checkpoint file for %s", name.c_str());
+  file.write((const char*)&header, sizeof(Header));
+  file.write((const char*)fields.data(), fields.size() * sizeof(double));
+  file.write((const char*)states.data(), states.size() * sizeof(double));
+  file.close();
+
+  // write the adapted mesh if it differs from the input mesh
+  std::string mesh_file;
+  if (write_mesh) {
+    mesh_file = name + "_mesh.smb";
+    d->get_apf_mesh()->writeNative(mesh_file.c_str());
+  }
+
+  // write the manifest
+  if (! PCU_Comm_Self()) {
+    ParameterList manifest;
+    manifest.set<std::string>("name", name);
+    manifest.set<int>("step", step);
+    manifest.set<int>("ranks", PCU_Comm_Peers());
+    manifest.set<std::string>("mesh file", mesh_file);
+    manifest.set<bool>("history", m->has_history());
+    manifest.set<int>("nodal fields", (int)nodal.size());
+    Teuchos::writeParameterListToYamlFile(manifest, name + ".yaml");
+  }
+
+  long num_values = fields.size() + states.size();
+  long bytes = sizeof(Header) + num_values * sizeof(double);
+  PCU_Add_Longs(&bytes, 1);
+  auto t1 = PCU_Time();
+  goal::print(" > checkpoint %s written: %ld bytes in %f seconds",
+      name.c_str(), bytes, t1 - t0);
+}
+
+ParameterList read_checkpoint_manifest(std::string const& manifest) {
+  ParameterList p;
+  auto pp = Teuchos::Ptr<ParameterList>(&p);
+  Teuchos::updateParametersFromYamlFile(manifest, pp);
+  GOAL_ALWAYS_ASSERT(p.isType<std::string>("name"));
+  GOAL_ALWAYS_ASSERT(p.isType<int>("step"));
+  GOAL_ALWAYS_ASSERT(p.isType<int>("ranks"));
+  GOAL_ALWAYS_ASSERT(p.isType<int>("nodal fields"));
+  if (p.get<int>("ranks") != PCU_Comm_Peers())
+    goal::fail("checkpoint written with %d ranks", p.get<int>("ranks"));
+  return p;
+}
+
+int read_checkpoint(
+    ParameterList const& manifest,
+    Mechanics* m,
+    goal::Discretization* d,
+    std::vector<apf::Field*>& nodal) {
+
+  auto t0 = PCU_Time();
+  auto name = manifest.get<std::string>("name");
+  auto step = manifest.get<int>("step");
+  GOAL_ALWAYS_ASSERT(manifest.get<bool>("history") == m->has_history());
+
+  // read the rank-local binary data
+  Header header;
+  std::ifstream file(get_rank_file(name).c_str(), std::ios::binary);
+  if (! file.is_open())
+    goal::fail("could not open checkpoint file for %s", name.c_str());
+  file.read((char*)&header, sizeof(Header));
+  GOAL_ALWAYS_ASSERT(header.magic == magic);
+  GOAL_ALWAYS_ASSERT(header.version == version);
+  GOAL_ALWAYS_ASSERT(header.step == step);
+  std::vector<double> fields(header.num_field_values);
+  std::vector<double> states(header.num_state_values);
+  file.read((char*)fields.data(), fields.size() * sizeof(double));
+  file.read((char*)states.data(), states.size() * sizeof(double));
+  GOAL_ALWAYS_ASSERT(file.good());
+  file.close();
+
+  // restore the displacement, nodal fields and history
+  nodal = create_nodal_fields(m, manifest.get<int>("nodal fields"));
+  unpack_fields(get_fields(m, nodal), fields);
+  unpack_states(m, d, states);
+
+  auto t1 = PCU_Time();
+  goal::print(" > checkpoint %s read in %f seconds", name.c_str(), t1 - t0);
+  return step;
+}
+
+} // end namespace ml
@@ -0,0 +1,69 @@
+#ifndef ml_checkpoint_hpp
+#define ml_checkpoint_hpp
+
+/// @file ml_checkpoint.hpp
+
+#include <vector>
+#include <Teuchos_ParameterList.hpp>
+
+/// @cond
+namespace apf {
+class Field;
+}
+
+namespace goal {
+class Discretization;
+}
+/// @endcond
+
+namespace ml {
+
+using Teuchos::ParameterList;
+
+/// @cond
+class Mechanics;
+/// @endcond
+
+/// @brief Write a checkpoint of the displacement and history states.
+/// @param p The checkpoint parameter list.
+/// @param step The solver step this checkpoint restarts from.
+/// @param m The relevant mechanics object.
+/// @param d The relevant discretization object.
+/// @param write_mesh True if the (adapted) mesh should be written.
+/// @param nodal Additional scalar nodal fields with the shape of the
+/// displacement fields, such as the kinematic history of a dynamic
+/// solve saved by \ref ml::save_to_fields.
+/// @details Each rank writes the values of its displacement fields,
+/// nodal fields and history states in a compact binary file. Rank 0
+/// writes a small yaml manifest that describes the checkpoint.
+void write_checkpoint(
+    ParameterList const& p,
+    int step,
+    Mechanics* m,
+    goal::Discretization* d,
+    bool write_mesh,
+    std::vector<apf::Field*> const& nodal = {});
+
+/// @brief Read a checkpoint manifest.
+/// @param manifest The path to the manifest file.
+/// @details The manifest is used to select the mesh file to build the
+/// discretization with before the checkpoint data is read.
+ParameterList read_checkpoint_manifest(std::string const& manifest);
+
+/// @brief Read a checkpoint of the displacement and history states.
+/// @param manifest The checkpoint manifest parameter list.
+/// @param m The relevant mechanics object.
+/// @param d The relevant discretization object.
+/// @param nodal Filled with newly created nodal fields holding the
+/// values of the nodal fields passed to \ref ml::write_checkpoint, in
+/// the same order. The caller owns them.
+/// @returns The solver step to restart from.
+int read_checkpoint(
+    ParameterList const& manifest,
+    Mechanics* m,
+    goal::Discretization* d,
+    std::vector<apf::Field*>& nodal);
+
+} // end namespace ml
+
+#endif
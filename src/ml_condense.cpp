@@ -0,0 +1,346 @@
+#include <apf.h>
+#include <apfMesh.h>
+#include <apfShape.h>
+#include <goal_control.hpp>
+#include <goal_field.hpp>
+#include <goal_indexer.hpp>
+#include <goal_sol_info.hpp>
+#include <PCU.h>
+#include <Teuchos_SerialDenseSolver.hpp>
+
+#include "ml_condense.hpp"
+#include "ml_linear_algebra.hpp"
+#include "ml_linear_solver.hpp"
+
+namespace ml {
+
+using DenseMatrix = Teuchos::SerialDenseMatrix<int, double>;
+using DenseSolver = Teuchos::SerialDenseSolver<int, double>;
+
+static goal::LO const invalid_lid =
+  Teuchos::OrdinalTraits<goal::LO>::invalid();
+
+static void get_block(
+    goal::Matrix const& A,
+    std::vector<goal::LO> const& col_lids,
+    std::vector<goal::LO> const& rows,
+    std::vector<goal::LO> const& cols,
+    std::vector<int>& position,
+    DenseMatrix& block) {
+  size_t n = 0;
+  auto max = A.getNodeMaxNumRowEntries();
+  Teuchos::Array<goal::LO> idx(max);
+  Teuchos::Array<goal::ST> vals(max);
+  block.shape(rows.size(), cols.size());
+  for (size_t j = 0; j < cols.size(); ++j)
+    position[cols[j]] = j;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    A.getLocalRowCopy(rows[i], idx(), vals(), n);
+    for (size_t j = 0; j < n; ++j) {
+      auto lid = col_lids[idx[j]];
+      if (lid == invalid_lid) continue;
+      int p = position[lid];
+      if (p >= 0) block(i, p) += vals[j];
+    }
+  }
+  for (size_t j = 0; j < cols.size(); ++j)
+    position[cols[j]] = -1;
+}
+
+Condensation::Condensation(
+    goal::Indexer* i,
+    goal::SolInfo* s,
+    std::vector<goal::Field*> const& u)
+    : indexer(i),
+      info(s),
+      num_interior(0) {
+  auto t0 = PCU_Time();
+  build_elems(u);
+  if (! is_active()) {
+    goal::print(" > no interior dofs to condense");
+    return;
+  }
+  build_maps();
+  build_graphs();
+  auto t1 = PCU_Time();
+  auto num_dofs = info->owned->R->getGlobalLength();
+  auto num_skel = owned_rhs->getGlobalLength();
+  auto nnz = info->owned->dRdu->getGlobalNumEntries();
+  auto skel_nnz = owned_S->getGlobalNumEntries();
+  goal::print(" > solved dofs: %lu of %lu", num_skel, num_dofs);
+  goal::print(" > solved nonzeros: %lu of %lu", skel_nnz, nnz);
+  goal::print(" > condensation setup time: %f seconds", t1 - t0);
+}
+
+void Condensation::build_elems(std::vector<goal::Field*> const& u) {
+
+  // interior nodes are the trailing nodes of an element's node list
+  auto mesh = indexer->get_apf_mesh();
+  auto dim = mesh->getDimension();
+  auto shape = apf::getShape(u[0]->get_apf_field());
+  auto ghost_map = info->ghost->R->getMap();
+  auto owned_map = info->owned->R->getMap();
+  is_interior.assign(ghost_map->getNodeNumElements(), false);
+  apf::MeshEntity* ent;
+  auto it = mesh->begin(dim);
+  while ((ent = mesh->iterate(it))) {
+    auto type = mesh->getType(ent);
+    int num_int = shape->countNodesOn(type);
+    if (num_int == 0) continue;
+    int num_nodes = shape->getEntityShape(type)->countNodes();
+    Elem elem;
+    for (int node = 0; node < num_nodes; ++node) {
+      for (size_t d = 0; d < u.size(); ++d) {
+        auto lid = indexer->get_ghost_lid(d, ent, node);
+        if (node < num_nodes - num_int) {
+          elem.skeleton.push_back(lid);
+          continue;
+        }
+        auto gid = ghost_map->getGlobalElement(lid);
+        auto owned_lid = owned_map->getLocalElement(gid);
+        GOAL_ALWAYS_ASSERT(owned_lid != invalid_lid);
+        elem.interior.push_back(lid);
+        elem.owned_interior.push_back(owned_lid);
+        is_interior[lid] = true;
+      }
+    }
+    num_interior += elem.interior.size();
+    elems.push_back(elem);
+  }
+  mesh->end(it);
+  long total = num_interior;
+  PCU_Add_Longs(&total, 1);
+  num_interior = total;
+}
+
+void Condensation::build_maps() {
+  auto ghost_map = info->ghost->R->getMap();
+  auto owned_map = info->owned->R->getMap();
+  Teuchos::Array<goal::GO> ghost_gids;
+  Teuchos::Array<goal::GO> owned_gids;
+  skeleton_idx.assign(ghost_map->getNodeNumElements(), invalid_lid);
+  for (size_t lid = 0; lid < ghost_map->getNodeNumElements(); ++lid) {
+    if (is_interior[lid]) continue;
+    skeleton_idx[lid] = skeleton_lids.size();
+    skeleton_lids.push_back(lid);
+    ghost_gids.push_back(ghost_map->getGlobalElement(lid));
+  }
+  for (size_t lid = 0; lid < owned_map->getNodeNumElements(); ++lid) {
+    auto gid = owned_map->getGlobalElement(lid);
+    if (is_interior[ghost_map->getLocalElement(gid)]) continue;
+    owned_skeleton_lids.push_back(lid);
+    owned_gids.push_back(gid);
+  }
+  auto comm = owned_map->getComm();
+  auto base = owned_map->getIndexBase();
+  auto num = Teuchos::OrdinalTraits<Tpetra::global_size_t>::invalid();
+  auto ghost_skel = Teuchos::rcp(new Map(num, ghost_gids(), base, comm));
+  auto owned_skel = Teuchos::rcp(new Map(num, owned_gids(), base, comm));
+  exporter = Teuchos::rcp(new goal::Export(ghost_skel, owned_skel));
+  importer = Teuchos::rcp(new Import(owned_skel, ghost_skel));
+  b = Teuchos::rcp(new goal::Vector(ghost_map));
+  ghost_rhs = Teuchos::rcp(new goal::Vector(ghost_skel));
+  owned_rhs = Teuchos::rcp(new goal::Vector(owned_skel));
+  ghost_x = Teuchos::rcp(new goal::Vector(ghost_skel));
+  owned_x = Teuchos::rcp(new goal::Vector(owned_skel));
+  for (size_t e = 0; e < elems.size(); ++e)
+    for (auto lid : elems[e].skeleton)
+      elems[e].skeleton_gids.push_back(ghost_map->getGlobalElement(lid));
+}
+
+void Condensation::build_graphs() {
+
+  // the element corrections only couple skeleton dofs of one element,
+  // so the skeleton graph is the restriction of the full graph
+  auto A = info->ghost->dRdu->getCrsGraph();
+  auto ghost_map = info->ghost->R->getMap();
+  auto col_map = A->getColMap();
+  auto ghost_skel = ghost_rhs->getMap();
+  auto owned_skel = owned_rhs->getMap();
+  auto max = A->getNodeMaxNumRowEntries();
+  auto ghost_graph = Teuchos::rcp(new Graph(ghost_skel, max));
+  size_t n = 0;
+  Teuchos::Array<goal::LO> idx(max);
+  for (size_t r = 0; r < skeleton_lids.size(); ++r) {
+    Teuchos::Array<goal::GO> cols;
+    A->getLocalRowCopy(skeleton_lids[r], idx(), n);
+    for (size_t j = 0; j < n; ++j) {
+      auto gid = col_map->getGlobalElement(idx[j]);
+      if (! is_interior[ghost_map->getLocalElement(gid)])
+        cols.push_back(gid);
+    }
+    ghost_graph->insertGlobalIndices(ghost_skel->getGlobalElement(r), cols());
+  }
+  ghost_graph->fillComplete(owned_skel, owned_skel);
+  auto owned_graph = Teuchos::rcp(new Graph(owned_skel, 0));
+  owned_graph->doExport(*ghost_graph, *exporter, Tpetra::INSERT);
+  owned_graph->fillComplete(owned_skel, owned_skel);
+  ghost_S = Teuchos::rcp(new goal::Matrix(ghost_graph));
+  owned_S = Teuchos::rcp(new goal::Matrix(owned_graph));
+
+  // map the column ids of the ghost jacobian to its row ids once
+  col_lids.resize(col_map->getNodeNumElements());
+  for (size_t lid = 0; lid < col_lids.size(); ++lid)
+    col_lids[lid] = ghost_map->getLocalElement(col_map->getGlobalElement(lid));
+  position.assign(ghost_map->getNodeNumElements(), -1);
+}
+
+void Condensation::condense_elem(goal::Matrix const& A, Elem& e) {
+  auto& interior = e.interior;
+  auto& skeleton = e.skeleton;
+  auto& A_II_inv = e.A_II_inv;
+  auto& A_SI = e.A_SI;
+  auto& W = e.W;
+  auto& C = e.C;
+  DenseMatrix A_IS;
+  get_block(A, col_lids, interior, interior, position, A_II_inv);
+  get_block(A, col_lids, interior, skeleton, position, A_IS);
+  get_block(A, col_lids, skeleton, interior, position, A_SI);
+  DenseSolver solver;
+  solver.setMatrix(Teuchos::rcpFromRef(A_II_inv));
+  GOAL_ALWAYS_ASSERT(solver.invert() == 0);
+  W.shape(interior.size(), skeleton.size());
+  W.multiply(Teuchos::NO_TRANS, Teuchos::NO_TRANS, 1.0, A_II_inv, A_IS, 0.0);
+  C.shape(skeleton.size(), skeleton.size());
+  C.multiply(Teuchos::NO_TRANS, Teuchos::NO_TRANS, 1.0, A_SI, W, 0.0);
+}
+
+void Condensation::condense() {
+
+  // goal has already exported the full jacobian, but the ghost jacobian
+  // and residual still hold the local element contributions, so every
+  // interior block is available on this rank
+  auto A = info->ghost->dRdu;
+  b->update(-1.0, *(info->ghost->R), 0.0);
+  for (size_t i = 0; i < elems.size(); ++i)
+    condense_elem(*A, elems[i]);
+
+  // gather the skeleton rows of the ghost jacobian and residual
+  size_t n = 0;
+  auto max = A->getNodeMaxNumRowEntries();
+  Teuchos::Array<goal::LO> idx(max);
+  Teuchos::Array<goal::ST> vals(max);
+  auto ghost_map = info->ghost->R->getMap();
+  auto col_map = A->getColMap();
+  auto bv = b->getData();
+  auto rhs = ghost_rhs->getDataNonConst();
+  ghost_S->resumeFill();
+  ghost_S->setAllToScalar(0.0);
+  for (size_t r = 0; r < skeleton_lids.size(); ++r) {
+    Teuchos::Array<goal::GO> cols;
+    Teuchos::Array<goal::ST> skel_vals;
+    A->getLocalRowCopy(skeleton_lids[r], idx(), vals(), n);
+    for (size_t j = 0; j < n; ++j) {
+      auto gid = col_map->getGlobalElement(idx[j]);
+      if (is_interior[ghost_map->getLocalElement(gid)]) continue;
+      cols.push_back(gid);
+      skel_vals.push_back(vals[j]);
+    }
+    auto row = ghost_map->getGlobalElement(skeleton_lids[r]);
+    ghost_S->sumIntoGlobalValues(row, cols(), skel_vals());
+    rhs[r] = bv[skeleton_lids[r]];
+  }
+
+  // subtract the element corrections
+  for (size_t i = 0; i < elems.size(); ++i) {
+    auto& e = elems[i];
+    auto num_int = e.interior.size();
+    auto num_skel = e.skeleton.size();
+    std::vector<double> y(num_int, 0.0);
+    for (size_t k = 0; k < num_int; ++k)
+      for (size_t l = 0; l < num_int; ++l)
+        y[k] += e.A_II_inv(k, l) * bv[e.interior[l]];
+    Teuchos::Array<goal::ST> row_vals(num_skel);
+    for (size_t s = 0; s < num_skel; ++s) {
+      for (size_t t = 0; t < num_skel; ++t)
+        row_vals[t] = -e.C(s, t);
+      auto gids = Teuchos::arrayViewFromVector(e.skeleton_gids);
+      ghost_S->sumIntoGlobalValues(e.skeleton_gids[s], gids, row_vals());
+      for (size_t k = 0; k < num_int; ++k)
+        rhs[skeleton_idx[e.skeleton[s]]] -= e.A_SI(s, k) * y[k];
+    }
+  }
+  ghost_S->fillComplete(owned_rhs->getMap(), owned_rhs->getMap());
+
+  // sum the skeleton system into its owned rows
+  owned_S->resumeFill();
+  owned_S->setAllToScalar(0.0);
+  owned_S->doExport(*ghost_S, *exporter, Tpetra::ADD);
+  owned_rhs->putScalar(0.0);
+  owned_rhs->doExport(*ghost_rhs, *exporter, Tpetra::ADD);
+
+  // interior dofs never carry dirichlet conditions, so the owned
+  // dirichlet rows all live on the skeleton
+  auto dbc_rows = get_dbc_rows(info->owned->dRdu);
+  auto is_dbc = dbc_rows->getData();
+  auto R = info->owned->R->getData();
+  auto owned = owned_rhs->getDataNonConst();
+  auto row_map = owned_S->getRowMap();
+  auto skel_col_map = owned_S->getColMap();
+  Teuchos::Array<goal::LO> skel_idx(owned_S->getNodeMaxNumRowEntries());
+  Teuchos::Array<goal::ST> skel_vals(owned_S->getNodeMaxNumRowEntries());
+  for (size_t r = 0; r < owned_skeleton_lids.size(); ++r) {
+    auto lid = owned_skeleton_lids[r];
+    if (is_dbc[lid] == 0.0) continue;
+    auto gid = row_map->getGlobalElement(r);
+    owned_S->getLocalRowCopy(r, skel_idx(), skel_vals(), n);
+    for (size_t j = 0; j < n; ++j) {
+      bool diag = (skel_col_map->getGlobalElement(skel_idx[j]) == gid);
+      skel_vals[j] = (diag) ? 1.0 : 0.0;
+    }
+    owned_S->replaceLocalValues(r, skel_idx(0, n), skel_vals(0, n));
+    owned[r] = R[lid];
+  }
+  owned_S->fillComplete(owned_rhs->getMap(), owned_rhs->getMap());
+}
+
+void Condensation::recover(Teuchos::RCP<goal::Vector> du) {
+  ghost_x->doImport(*owned_x, *importer, Tpetra::INSERT);
+  auto x = du->getDataNonConst();
+  auto xs = owned_x->getData();
+  auto xg = ghost_x->getData();
+  auto bv = b->getData();
+  for (size_t r = 0; r < owned_skeleton_lids.size(); ++r)
+    x[owned_skeleton_lids[r]] = xs[r];
+  for (size_t i = 0; i < elems.size(); ++i) {
+    auto& e = elems[i];
+    for (size_t k = 0; k < e.interior.size(); ++k) {
+      double val = 0.0;
+      for (size_t l = 0; l < e.interior.size(); ++l)
+        val += e.A_II_inv(k, l) * bv[e.interior[l]];
+      for (size_t s = 0; s < e.skeleton.size(); ++s)
+        val -= e.W(k, s) * xg[skeleton_idx[e.skeleton[s]]];
+      x[e.owned_interior[k]] = val;
+    }
+  }
+}
+
+void Condensation::solve(
+    LinearSolver* s,
+    Teuchos::RCP<goal::Vector> du) {
+  GOAL_DEBUG_ASSERT(is_active());
+  auto t0 = PCU_Time();
+  condense();
+  auto t1 = PCU_Time();
+  owned_x->putScalar(0.0);
+  s->solve(owned_S, owned_x, owned_rhs);
+  auto t2 = PCU_Time();
+  recover(du);
+  auto t3 = PCU_Time();
+  goal::print(" > condensation time: %f seconds", t1 - t0);
+  goal::print(" > skeleton solve time: %f seconds", t2 - t1);
+  goal::print(" > interior recovery time: %f seconds", t3 - t2);
+}
+
+Condensation* create_condensation(
+    goal::Indexer* i,
+    goal::SolInfo* s,
+    std::vector<goal::Field*> const& u) {
+  return new Condensation(i, s, u);
+}
+
+void destroy_condensation(Condensation* c) {
+  delete c;
+}
+
+} // end namespace ml
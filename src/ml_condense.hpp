@@ -0,0 +1,120 @@
+#ifndef ml_condense_hpp
+#define ml_condense_hpp
+
+/// @file ml_condense.hpp
+
+#include <goal_data_types.hpp>
+#include <Teuchos_SerialDenseMatrix.hpp>
+#include <Tpetra_CrsGraph.hpp>
+
+/// @cond
+namespace goal {
+class Field;
+class Indexer;
+class SolInfo;
+}
+/// @endcond
+
+namespace ml {
+
+/// @cond
+class LinearSolver;
+/// @endcond
+
+/// @brief Static condensation of element-interior DOFs.
+/// @details DOFs on nodes classified on the interior of an element
+/// couple only to the DOFs of that element. They are eliminated element
+/// by element from the rank-local contributions that remain in the
+/// ghost Jacobian, \f$ S = A_{SS} - A_{SI} A_{II}^{-1} A_{IS} \f$. The
+/// skeleton system \f$ S \f$ is exported, equipped with Dirichlet rows
+/// and handed to the linear solver. The interior values are then
+/// recovered element by element. goal still assembles and exports the
+/// full Jacobian first, so this reduces the size of the linear solve,
+/// not the assembly cost. The skeleton maps and matrix graphs are built
+/// once and persist as long as the indexer does.
+class Condensation {
+
+  public:
+
+    /// @brief Build the skeleton maps and matrix graphs.
+    /// @param i The primal indexer.
+    /// @param s The primal solution information built on the indexer.
+    /// @param u The displacement fields numbered by the indexer.
+    Condensation(
+        goal::Indexer* i,
+        goal::SolInfo* s,
+        std::vector<goal::Field*> const& u);
+
+    /// @brief Returns true if there are interior DOFs to condense.
+    bool is_active() { return num_interior > 0; }
+
+    /// @brief Solve the Newton system by static condensation.
+    /// @param s The linear solver for the skeleton system.
+    /// @param du The owned solution vector to fill.
+    /// @details This expects a freshly assembled primal Jacobian, with
+    /// the owned residual already scaled by -1, so that the system
+    /// solved is \f$ \frac{\partial R}{\partial u} \delta u = -R \f$.
+    void solve(LinearSolver* s, Teuchos::RCP<goal::Vector> du);
+
+  private:
+
+    using DenseMatrix = Teuchos::SerialDenseMatrix<int, double>;
+    using Graph = Tpetra::CrsGraph<goal::LO, goal::GO, goal::KNode>;
+    using Import = Tpetra::Import<goal::LO, goal::GO, goal::KNode>;
+
+    struct Elem {
+      std::vector<goal::LO> interior;
+      std::vector<goal::LO> skeleton;
+      std::vector<goal::LO> owned_interior;
+      std::vector<goal::GO> skeleton_gids;
+      DenseMatrix A_II_inv;
+      DenseMatrix A_SI;
+      DenseMatrix W;
+      DenseMatrix C;
+    };
+
+    void build_elems(std::vector<goal::Field*> const& u);
+    void build_maps();
+    void build_graphs();
+    void condense_elem(goal::Matrix const& A, Elem& e);
+    void condense();
+    void recover(Teuchos::RCP<goal::Vector> du);
+
+    goal::Indexer* indexer;
+    goal::SolInfo* info;
+    size_t num_interior;
+    std::vector<Elem> elems;
+    std::vector<bool> is_interior;
+    std::vector<goal::LO> skeleton_lids;
+    std::vector<goal::LO> skeleton_idx;
+    std::vector<goal::LO> owned_skeleton_lids;
+    std::vector<goal::LO> col_lids;
+    std::vector<int> position;
+
+    Teuchos::RCP<goal::Vector> b;
+    Teuchos::RCP<goal::Vector> ghost_rhs;
+    Teuchos::RCP<goal::Vector> owned_rhs;
+    Teuchos::RCP<goal::Vector> ghost_x;
+    Teuchos::RCP<goal::Vector> owned_x;
+    Teuchos::RCP<goal::Matrix> ghost_S;
+    Teuchos::RCP<goal::Matrix> owned_S;
+    Teuchos::RCP<goal::Export> exporter;
+    Teuchos::RCP<Import> importer;
+};
+
+/// @brief Create a static condensation object.
+/// @param i The primal indexer.
+/// @param s The primal solution information built on the indexer.
+/// @param u The displacement fields numbered by the indexer.
+Condensation* create_condensation(
+    goal::Indexer* i,
+    goal::SolInfo* s,
+    std::vector<goal::Field*> const& u);
+
+/// @brief Destroy a static condensation object.
+/// @param c The \ref ml::Condensation object to destroy.
+void destroy_condensation(Condensation* c);
+
+} // end namespace ml
+
+#endif
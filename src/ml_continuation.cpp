@@ -0,0 +1,71 @@
+#include <apf.h>
+#include <apfMesh.h>
+#include <apfShape.h>
+#include <goal_control.hpp>
+#include <goal_field.hpp>
+
+#include "ml_continuation.hpp"
+#include "ml_mechanics.hpp"
+
+namespace ml {
+
+apf::Field* save_p1_displacement(Mechanics* m) {
+  auto u = m->get_u();
+  GOAL_ALWAYS_ASSERT(m->get_p_order() == 1);
+  auto mesh = apf::getMesh(u[0]->get_apf_field());
+  auto u1 = apf::createFieldOn(mesh, "p1_displacement", apf::VECTOR);
+  apf::Vector3 value(0, 0, 0);
+  apf::MeshEntity* vtx;
+  auto it = mesh->begin(0);
+  while ((vtx = mesh->iterate(it))) {
+    for (size_t i = 0; i < u.size(); ++i)
+      value[i] = apf::getScalar(u[i]->get_apf_field(), vtx, 0);
+    apf::setVector(u1, vtx, 0, value);
+  }
+  mesh->end(it);
+  return u1;
+}
+
+static void get_node_value(
+    apf::Field* u1,
+    apf::MeshEntity* ent,
+    apf::FieldShape* shape,
+    int node,
+    apf::Vector3& value) {
+  auto mesh = apf::getMesh(u1);
+  if (mesh->getType(ent) == apf::Mesh::VERTEX) {
+    apf::getVector(u1, ent, 0, value);
+    return;
+  }
+  apf::Vector3 xi;
+  shape->getNodeXi(mesh->getType(ent), node, xi);
+  auto me = apf::createMeshElement(mesh, ent);
+  auto e = apf::createElement(u1, me);
+  apf::getVector(e, xi, value);
+  apf::destroyElement(e);
+  apf::destroyMeshElement(me);
+}
+
+void interpolate_p1_displacement(apf::Field* u1, Mechanics* m) {
+  auto u = m->get_u();
+  auto mesh = apf::getMesh(u1);
+  auto shape = apf::getShape(u[0]->get_apf_field());
+  apf::Vector3 value;
+  for (int d = 0; d <= mesh->getDimension(); ++d) {
+    if (! shape->hasNodesIn(d)) continue;
+    apf::MeshEntity* ent;
+    auto it = mesh->begin(d);
+    while ((ent = mesh->iterate(it))) {
+      int num_nodes = shape->countNodesOn(mesh->getType(ent));
+      for (int n = 0; n < num_nodes; ++n) {
+        get_node_value(u1, ent, shape, n, value);
+        for (size_t i = 0; i < u.size(); ++i)
+          apf::setScalar(u[i]->get_apf_field(), ent, n, value[i]);
+      }
+    }
+    mesh->end(it);
+  }
+  apf::destroyField(u1);
+}
+
+} // end namespace ml
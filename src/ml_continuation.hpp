@@ -0,0 +1,38 @@
+#ifndef ml_continuation_hpp
+#define ml_continuation_hpp
+
+/// @file ml_continuation.hpp
+
+/// @cond
+namespace apf {
+class Field;
+}
+/// @endcond
+
+namespace ml {
+
+/// @cond
+class Mechanics;
+/// @endcond
+
+/// @brief Save a p1 displacement solution to a standalone field.
+/// @param m A mechanics object with p1 displacement fields.
+/// @returns A linear vector field that outlives the mechanics object.
+/// @details The p1 and high order mechanics objects share field and
+/// state names, so they cannot exist on the mesh at the same time.
+/// The history states are not saved. A static solve is a single load
+/// step whose current states are recomputed from the initial old
+/// states in every Newton iteration, so the p1 states carry no
+/// information the high order solve would use.
+apf::Field* save_p1_displacement(Mechanics* m);
+
+/// @brief Interpolate a p1 displacement onto higher order fields.
+/// @param u1 The field returned by \ref ml::save_p1_displacement.
+/// @param m A mechanics object with higher order displacement fields.
+/// @details The linear field is evaluated at every Lagrange node of
+/// the displacement fields. The field u1 is destroyed afterwards.
+void interpolate_p1_displacement(apf::Field* u1, Mechanics* m);
+
+} // end namespace ml
+
+#endif
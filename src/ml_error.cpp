@@ -0,0 +1,372 @@
+#include <map>
+#include <set>
+#include <apf.h>
+#include <apfMesh.h>
+#include <goal_control.hpp>
+#include <goal_discretization.hpp>
+#include <goal_field.hpp>
+#include <goal_states.hpp>
+#include <MiniTensor.h>
+#include <PCU.h>
+#include <Teuchos_SerialDenseMatrix.hpp>
+#include <Teuchos_SerialDenseSolver.hpp>
+
+#include "ml_error.hpp"
+#include "ml_mechanics.hpp"
+#include "ml_polynomial.hpp"
+
+namespace ml {
+
+using DenseMatrix = Teuchos::SerialDenseMatrix<int, double>;
+using DenseSolver = Teuchos::SerialDenseSolver<int, double>;
+
+static char const* const side_weights_name = "ml_side_dz";
+
+struct Patch {
+  apf::Vector3 center;
+  double h;
+  DenseMatrix coeffs;
+};
+
+struct Samples {
+  std::vector<apf::Vector3> points;
+  std::vector<std::vector<double> > values;
+};
+
+// samples of elements on other parts, by the local shared vertex
+struct RemoteSamples {
+  std::vector<Samples> elems;
+  std::map<apf::MeshEntity*, std::vector<size_t> > by_vertex;
+};
+
+static std::vector<apf::MeshEntity*> get_patch_elems(
+    apf::Mesh* mesh, apf::MeshEntity* elem) {
+  apf::Adjacent adj;
+  auto dim = mesh->getDimension();
+  apf::getBridgeAdjacent(mesh, elem, 0, dim, adj);
+  std::vector<apf::MeshEntity*> elems(1, elem);
+  for (size_t i = 0; i < adj.getSize(); ++i)
+    if (adj[i] != elem) elems.push_back(adj[i]);
+  return elems;
+}
+
+static void sample_elem(
+    apf::Mesh* mesh,
+    apf::MeshEntity* elem,
+    std::vector<goal::Field*> const& z,
+    int sample_degree,
+    Samples& samples) {
+  apf::Vector3 x;
+  apf::Vector3 xi;
+  auto num_dims = (int)z.size();
+  auto me = apf::createMeshElement(mesh, elem);
+  std::vector<apf::Element*> ze(num_dims);
+  for (int d = 0; d < num_dims; ++d)
+    ze[d] = apf::createElement(z[d]->get_apf_field(), me);
+  for (int ip = 0; ip < apf::countIntPoints(me, sample_degree); ++ip) {
+    apf::getIntPoint(me, sample_degree, ip, xi);
+    apf::mapLocalToGlobal(me, xi, x);
+    std::vector<double> value(num_dims);
+    for (int d = 0; d < num_dims; ++d)
+      value[d] = apf::getScalar(ze[d], xi);
+    samples.points.push_back(x);
+    samples.values.push_back(value);
+  }
+  for (int d = 0; d < num_dims; ++d)
+    apf::destroyElement(ze[d]);
+  apf::destroyMeshElement(me);
+}
+
+static void exchange_samples(
+    apf::Mesh* mesh,
+    std::vector<goal::Field*> const& z,
+    int sample_degree,
+    RemoteSamples& remote) {
+
+  // send the samples of elements touching a part boundary to every part
+  // that shares one of their vertices
+  int id = 0;
+  int num_dims = z.size();
+  apf::MeshEntity* elem;
+  PCU_Comm_Begin();
+  auto it = mesh->begin(mesh->getDimension());
+  while ((elem = mesh->iterate(it))) {
+    Samples samples;
+    apf::Downward verts;
+    int num_verts = mesh->getDownward(elem, 0, verts);
+    for (int v = 0; v < num_verts; ++v) {
+      if (! mesh->isShared(verts[v])) continue;
+      if (samples.points.empty())
+        sample_elem(mesh, elem, z, sample_degree, samples);
+      int num_samples = samples.points.size();
+      apf::Copies remotes;
+      mesh->getRemotes(verts[v], remotes);
+      for (auto& copy : remotes) {
+        int to = copy.first;
+        PCU_COMM_PACK(to, copy.second);
+        PCU_COMM_PACK(to, id);
+        PCU_COMM_PACK(to, num_samples);
+        for (int s = 0; s < num_samples; ++s) {
+          PCU_COMM_PACK(to, samples.points[s]);
+          PCU_Comm_Pack(to, &(samples.values[s][0]),
+              num_dims * sizeof(double));
+        }
+      }
+    }
+    ++id;
+  }
+  mesh->end(it);
+  PCU_Comm_Send();
+
+  // an element that shares several vertices with this part arrives once
+  // per vertex but is stored once
+  std::map<std::pair<int, int>, size_t> index;
+  while (PCU_Comm_Receive()) {
+    int from = PCU_Comm_Sender();
+    apf::MeshEntity* vtx;
+    int num_samples;
+    PCU_COMM_UNPACK(vtx);
+    PCU_COMM_UNPACK(id);
+    PCU_COMM_UNPACK(num_samples);
+    Samples samples;
+    samples.points.resize(num_samples);
+    samples.values.resize(num_samples, std::vector<double>(num_dims));
+    for (int s = 0; s < num_samples; ++s) {
+      PCU_COMM_UNPACK(samples.points[s]);
+      PCU_Comm_Unpack(&(samples.values[s][0]), num_dims * sizeof(double));
+    }
+    auto key = std::make_pair(from, id);
+    if (! index.count(key)) {
+      index[key] = remote.elems.size();
+      remote.elems.push_back(samples);
+    }
+    remote.by_vertex[vtx].push_back(index[key]);
+  }
+}
+
+static bool fit_patch(
+    apf::Mesh* mesh,
+    apf::MeshEntity* elem,
+    std::vector<goal::Field*> const& z,
+    std::vector<Monomial> const& monomials,
+    RemoteSamples const& remote,
+    int sample_degree,
+    Patch& patch) {
+
+  // sample the dual solution over the vertex patch, including the
+  // patch elements on other parts
+  Samples local;
+  auto num_dims = (int)z.size();
+  auto elems = get_patch_elems(mesh, elem);
+  for (size_t i = 0; i < elems.size(); ++i)
+    sample_elem(mesh, elems[i], z, sample_degree, local);
+  std::set<size_t> remote_elems;
+  apf::Downward verts;
+  int num_verts = mesh->getDownward(elem, 0, verts);
+  for (int v = 0; v < num_verts; ++v) {
+    auto rit = remote.by_vertex.find(verts[v]);
+    if (rit == remote.by_vertex.end()) continue;
+    remote_elems.insert(rit->second.begin(), rit->second.end());
+  }
+  auto& points = local.points;
+  auto& values = local.values;
+  for (auto r : remote_elems) {
+    auto& samples = remote.elems[r];
+    points.insert(points.end(), samples.points.begin(), samples.points.end());
+    values.insert(values.end(), samples.values.begin(), samples.values.end());
+  }
+
+  // the local problem is under-determined on small boundary patches
+  int num_samples = points.size();
+  int num_coeffs = monomials.size();
+  if (num_samples < num_coeffs) return false;
+
+  // scale the local coordinates for conditioning
+  patch.center = apf::getLinearCentroid(mesh, elem);
+  patch.h = 0.0;
+  for (int s = 0; s < num_samples; ++s)
+    patch.h = std::max(patch.h, (points[s] - patch.center).getLength());
+  GOAL_DEBUG_ASSERT(patch.h > 0.0);
+
+  // form and solve the least squares normal equations
+  DenseMatrix N(num_coeffs, num_coeffs);
+  DenseMatrix b(num_coeffs, num_dims);
+  patch.coeffs.shape(num_coeffs, num_dims);
+  std::vector<double> phi(num_coeffs);
+  for (int s = 0; s < num_samples; ++s) {
+    auto xs = (points[s] - patch.center) / patch.h;
+    for (int i = 0; i < num_coeffs; ++i)
+      phi[i] = eval_monomial(monomials[i], xs);
+    for (int i = 0; i < num_coeffs; ++i) {
+      for (int j = 0; j < num_coeffs; ++j)
+        N(i, j) += phi[i] * phi[j];
+      for (int d = 0; d < num_dims; ++d)
+        b(i, d) += phi[i] * values[s][d];
+    }
+  }
+  DenseSolver solver;
+  solver.setMatrix(Teuchos::rcpFromRef(N));
+  auto X = Teuchos::rcpFromRef(patch.coeffs);
+  solver.setVectors(X, Teuchos::rcpFromRef(b));
+  solver.factorWithEquilibration(true);
+  return (solver.solve() == 0);
+}
+
+static double eval_patch(
+    Patch const& patch,
+    std::vector<Monomial> const& monomials,
+    apf::Vector3 const& x,
+    int i) {
+  double value = 0.0;
+  auto xs = (x - patch.center) / patch.h;
+  for (size_t c = 0; c < monomials.size(); ++c)
+    value += patch.coeffs(c, i) * eval_monomial(monomials[c], xs);
+  return value;
+}
+
+static bool is_boundary_side(apf::Mesh* mesh, apf::MeshEntity* side) {
+  return (mesh->countUpward(side) == 1) && (! mesh->isShared(side));
+}
+
+static void recover_sides(
+    apf::Mesh* mesh,
+    apf::MeshEntity* elem,
+    std::vector<goal::Field*> const& z,
+    std::vector<Monomial> const& monomials,
+    Patch const& patch,
+    bool valid,
+    int q_degree,
+    apf::MeshTag*& tag) {
+
+  // store z+ - z_h at the integration points of the boundary sides
+  apf::Vector3 x;
+  apf::Vector3 xi;
+  apf::Downward sides;
+  auto num_dims = (int)z.size();
+  auto dim = mesh->getDimension();
+  int num_sides = mesh->getDownward(elem, dim - 1, sides);
+  for (int s = 0; s < num_sides; ++s) {
+    if (! is_boundary_side(mesh, sides[s])) continue;
+    auto me = apf::createMeshElement(mesh, sides[s]);
+    int num_ips = apf::countIntPoints(me, q_degree);
+    if (! tag)
+      tag = mesh->createDoubleTag(side_weights_name, num_ips * num_dims);
+    GOAL_ALWAYS_ASSERT(num_ips * num_dims == mesh->getTagSize(tag));
+    std::vector<double> dz(num_ips * num_dims, 0.0);
+    for (int i = 0; valid && (i < num_dims); ++i) {
+      auto ze = apf::createElement(z[i]->get_apf_field(), me);
+      for (int ip = 0; ip < num_ips; ++ip) {
+        apf::getIntPoint(me, q_degree, ip, xi);
+        apf::mapLocalToGlobal(me, xi, x);
+        dz[ip * num_dims + i] =
+          eval_patch(patch, monomials, x, i) - apf::getScalar(ze, xi);
+      }
+      apf::destroyElement(ze);
+    }
+    mesh->setDoubleTag(sides[s], tag, &(dz[0]));
+    apf::destroyMeshElement(me);
+  }
+}
+
+static void recover_elem(
+    apf::Mesh* mesh,
+    apf::MeshEntity* elem,
+    std::vector<goal::Field*> const& z,
+    std::vector<Monomial> const& monomials,
+    RemoteSamples const& remote,
+    goal::States* states,
+    int q_degree,
+    int sample_degree,
+    apf::MeshTag*& tag) {
+
+  Patch patch;
+  apf::Vector3 x;
+  apf::Vector3 xi;
+  apf::Vector3 grad;
+  auto num_dims = (int)z.size();
+  minitensor::Tensor<double> grad_dz(num_dims);
+  bool valid = fit_patch(
+      mesh, elem, z, monomials, remote, sample_degree, patch);
+
+  auto me = apf::createMeshElement(mesh, elem);
+  for (int ip = 0; ip < apf::countIntPoints(me, q_degree); ++ip) {
+    grad_dz.fill(minitensor::ZEROS);
+    if (valid) {
+      apf::getIntPoint(me, q_degree, ip, xi);
+      apf::mapLocalToGlobal(me, xi, x);
+      auto xs = (x - patch.center) / patch.h;
+      for (int i = 0; i < num_dims; ++i) {
+        auto ze = apf::createElement(z[i]->get_apf_field(), me);
+        apf::getGrad(ze, xi, grad);
+        apf::destroyElement(ze);
+        for (int j = 0; j < num_dims; ++j) {
+          double dzp = 0.0;
+          for (size_t c = 0; c < monomials.size(); ++c)
+            dzp += patch.coeffs(c, i) *
+              eval_monomial_deriv(monomials[c], xs, j);
+          grad_dz(i, j) = dzp / patch.h - grad[j];
+        }
+      }
+    }
+    states->set_tensor("grad_dz", elem, ip, grad_dz);
+  }
+  apf::destroyMeshElement(me);
+  recover_sides(mesh, elem, z, monomials, patch, valid, q_degree, tag);
+}
+
+void recover_dual_weights(Mechanics* m, goal::Discretization* d) {
+  auto t0 = PCU_Time();
+  auto mesh = d->get_apf_mesh();
+  auto dim = mesh->getDimension();
+  auto z = m->get_z();
+  auto states = m->get_states();
+  auto q_degree = m->get_q_degree();
+  auto p_enriched = m->get_p_order() + 1;
+  auto monomials = get_monomials(dim, p_enriched);
+  auto sample_degree = 2 * p_enriched;
+  RemoteSamples remote;
+  exchange_samples(mesh, z, sample_degree, remote);
+
+  destroy_side_weights(d);
+  apf::MeshTag* tag = 0;
+  apf::MeshEntity* elem;
+  auto it = mesh->begin(dim);
+  while ((elem = mesh->iterate(it)))
+    recover_elem(mesh, elem, z, monomials, remote, states, q_degree,
+        sample_degree, tag);
+  mesh->end(it);
+
+  auto t1 = PCU_Time();
+  goal::print(" > dual weights recovered in %f seconds", t1 - t0);
+}
+
+apf::MeshTag* find_side_weights(goal::Discretization* d) {
+  return d->get_apf_mesh()->findTag(side_weights_name);
+}
+
+void destroy_side_weights(goal::Discretization* d) {
+  auto mesh = d->get_apf_mesh();
+  auto tag = mesh->findTag(side_weights_name);
+  if (! tag) return;
+  apf::removeTagFromDimension(mesh, tag, mesh->getDimension() - 1);
+  mesh->destroyTag(tag);
+}
+
+double sum_error(Mechanics* m, goal::Discretization* d, double& bound) {
+  auto mesh = d->get_apf_mesh();
+  auto error = m->get_error_field();
+  double sums[2] = {0.0, 0.0};
+  apf::MeshEntity* elem;
+  auto it = mesh->begin(mesh->getDimension());
+  while ((elem = mesh->iterate(it))) {
+    double eta = apf::getScalar(error, elem, 0);
+    sums[0] += eta;
+    sums[1] += std::abs(eta);
+  }
+  mesh->end(it);
+  PCU_Add_Doubles(sums, 2);
+  bound = sums[1];
+  return sums[0];
+}
+
+} // end namespace ml
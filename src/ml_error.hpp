@@ -0,0 +1,59 @@
+#ifndef ml_error_hpp
+#define ml_error_hpp
+
+/// @file ml_error.hpp
+
+/// @cond
+namespace apf {
+class MeshTag;
+}
+
+namespace goal {
+class Discretization;
+}
+/// @endcond
+
+namespace ml {
+
+/// @cond
+class Mechanics;
+/// @endcond
+
+/// @brief Recover the enriched dual weights on each element.
+/// @param m The mechanics object with a solved dual problem.
+/// @param d The relevant discretization object.
+/// @details The enriched dual is recovered by patch least squares, not
+/// by local p+1 solves of the dual problem: for each element, a
+/// polynomial of degree p+1 is fit in the least squares sense to the
+/// dual solution sampled over the element's vertex patch. Patches that
+/// cross a part boundary include the samples of the elements on the
+/// neighboring parts. The gradient of the difference between this
+/// enriched dual and the dual solution is stored at each integration
+/// point in the "grad_dz" state. The difference itself is stored at the
+/// integration points of the boundary sides, see
+/// \ref ml::find_side_weights. APF and the states are not thread safe,
+/// so the elements are visited in a serial loop.
+void recover_dual_weights(Mechanics* m, goal::Discretization* d);
+
+/// @brief Find the dual weights on the boundary sides.
+/// @param d The relevant discretization object.
+/// @returns A side tag holding \f$ z^+ - z_h \f$ at the side
+/// integration points, component by component, or null if this part
+/// has no boundary sides.
+apf::MeshTag* find_side_weights(goal::Discretization* d);
+
+/// @brief Destroy the dual weights on the boundary sides.
+/// @param d The relevant discretization object.
+/// @details The tag would otherwise be written with the mesh.
+void destroy_side_weights(goal::Discretization* d);
+
+/// @brief Sum the element-wise error indicators across all ranks.
+/// @param m The mechanics object with computed error indicators.
+/// @param d The relevant discretization object.
+/// @param bound Set to the sum of the absolute values of the indicators.
+/// @returns The sum of the signed indicators.
+double sum_error(Mechanics* m, goal::Discretization* d, double& bound);
+
+} // end namespace ml
+
+#endif
@@ -16,6 +16,7 @@ static ParameterList get_valid_params() {
   p.set<double>("K", 0.0);
   p.set<double>("Y", 0.0);
   p.set<double>("alpha", 0.0);
+  p.set<double>("rho", 0.0);
   return p;
 }
 
@@ -153,13 +154,15 @@ PHX_EVALUATE_FIELDS(J2, workset) {
         states->set_tensor("Fp", e, ip, Fpn);
       }
 
-      else
+      // elastic step: the plastic state stays at its old value
+      else {
         states->set_scalar("eqps", e, ip, eqps);
+        states->set_tensor("Fp", e, ip, Fp);
+      }
 
       // compute stress
       ScalarT p = 0.5 * kappa * (J - 1.0 / J);
       sigma = I * p + s / J;
-      states->set_tensor("cauchy", e, ip, sigma);
       for (int i = 0; i < num_dims; ++i)
       for (int j = 0; j < num_dims; ++j)
         cauchy(elem, ip, i, j) = sigma(i, j);
@@ -0,0 +1,79 @@
+#include <apf.h>
+#include <goal_control.hpp>
+#include <goal_field.hpp>
+#include <goal_indexer.hpp>
+#include <goal_traits.hpp>
+#include <goal_workset.hpp>
+#include <Phalanx_DataLayout_MDALayout.hpp>
+
+#include "ml_ev_avg_disp.hpp"
+#include "ml_qoi.hpp"
+
+namespace ml {
+
+using Teuchos::rcp;
+
+template <typename EVALT, typename TRAITS>
+AvgDisp<EVALT, TRAITS>::AvgDisp(
+    std::vector<goal::Field*> const& u,
+    QoI* q,
+    goal::Indexer* i,
+    int type)
+    : qoi(q),
+      indexer(i),
+      wdv(u[0]->wdv_name(), u[0]->ip0_dl(type)) {
+
+  component = qoi->get_component();
+  GOAL_DEBUG_ASSERT(component < (int)u.size());
+  field = u[component];
+
+  num_nodes = field->get_num_nodes(type);
+  num_ips = field->get_num_ips(type);
+
+  auto n = field->basis_name();
+  auto dl = field->w_dl(type);
+  w = PHX::MDField<const double, Ent, Node, IP>(n, dl);
+
+  auto name = "Avg Disp: " + field->name();
+  PHX::Tag<ScalarT> op(name, rcp(new PHX::MDALayout<Dummy>(0)));
+
+  this->addDependentField(w);
+  this->addDependentField(wdv);
+  this->addEvaluatedField(op);
+  this->setName(name);
+}
+
+PHX_POST_REGISTRATION_SETUP(AvgDisp, data, fm) {
+  this->utils.setFieldData(w, fm);
+  this->utils.setFieldData(wdv, fm);
+  (void)data;
+}
+
+PHX_EVALUATE_FIELDS(AvgDisp, workset) {
+  apf::Vector3 xi(0, 0, 0);
+  auto q_degree = field->get_q_degree();
+  auto mesh = indexer->get_apf_mesh();
+  auto dJdu = qoi->get_ghost_dJdu();
+  GOAL_DEBUG_ASSERT(Teuchos::nonnull(dJdu));
+
+  for (int side = 0; side < workset.size; ++side) {
+    auto s = workset.entities[side];
+    auto me = apf::createMeshElement(mesh, s);
+    auto fe = apf::createElement(field->get_apf_field(), me);
+    for (int ip = 0; ip < num_ips; ++ip) {
+      apf::getIntPoint(me, q_degree, ip, xi);
+      qoi->add_value(apf::getScalar(fe, xi), wdv(side, ip));
+      for (int node = 0; node < num_nodes; ++node) {
+        goal::LO row = indexer->get_ghost_lid(component, s, node);
+        dJdu->sumIntoLocalValue(row, w(side, node, ip) * wdv(side, ip));
+      }
+    }
+    apf::destroyElement(fe);
+    apf::destroyMeshElement(me);
+  }
+}
+
+template class AvgDisp<goal::Traits::Residual, goal::Traits>;
+template class AvgDisp<goal::Traits::Jacobian, goal::Traits>;
+
+} // end namespace ml
@@ -0,0 +1,60 @@
+#ifndef ml_ev_avg_disp_hpp
+#define ml_ev_avg_disp_hpp
+
+/// @file ml_ev_avg_disp.hpp
+
+#include <Phalanx_Evaluator_Macros.hpp>
+#include <goal_dimension.hpp>
+
+/// @cond
+namespace goal {
+class Field;
+class Indexer;
+}
+/// @endcond
+
+namespace ml {
+
+/// @cond
+class QoI;
+/// @endcond
+
+PHX_EVALUATOR_CLASS(AvgDisp)
+
+  public:
+
+    /// @brief Construct the average displacement qoi evaluator.
+    /// @param u The displacement fields.
+    /// @param q The quantity of interest to accumulate into.
+    /// @param i The linear algebra indexer.
+    /// @param type The entity type to operate on.
+    AvgDisp(
+        std::vector<goal::Field*> const& u,
+        QoI* q,
+        goal::Indexer* i,
+        int type);
+
+  private:
+
+    using Dummy = goal::Dummy;
+    using Node = goal::Node;
+    using Ent = goal::Ent;
+    using IP = goal::IP;
+
+    goal::Field* field;
+    QoI* qoi;
+    goal::Indexer* indexer;
+
+    int component;
+    int num_nodes;
+    int num_ips;
+
+    // input
+    PHX::MDField<const double, Ent, IP> wdv;
+    PHX::MDField<const double, Ent, Node, IP> w;
+
+PHX_EVALUATOR_CLASS_END
+
+} // end namespace ml
+
+#endif
@@ -0,0 +1,142 @@
+#include <apf.h>
+#include <apfMesh.h>
+#include <apfShape.h>
+#include <goal_control.hpp>
+#include <goal_field.hpp>
+#include <goal_traits.hpp>
+#include <goal_workset.hpp>
+
+#include "ml_ev_cached_basis.hpp"
+
+namespace ml {
+
+template <typename EVALT, typename TRAITS>
+CachedBasis<EVALT, TRAITS>::CachedBasis(
+    goal::Field* u,
+    BasisCache* c,
+    int s,
+    int type)
+    : field(u),
+      cache(c),
+      set(s),
+      has_reference(false),
+      w(u->basis_name(), u->w_dl(type)),
+      grad_w(u->g_basis_name(), u->g_w_dl(type)),
+      wdv(u->wdv_name(), u->ip0_dl(type)) {
+
+  num_nodes = u->get_num_nodes(type);
+  num_ips = u->get_num_ips(type);
+  num_dims = u->get_num_dims();
+  q_degree = u->get_q_degree();
+
+  // the p1 gradients and the volume of an affine simplex are constant
+  auto f = u->get_apf_field();
+  auto mesh = apf::getMesh(f);
+  is_side = (apf::Mesh::typeDimension[type] < mesh->getDimension());
+  is_affine = (mesh->getShape()->getOrder() == 1) && apf::isSimplex(type);
+  is_affine = is_affine && (apf::getShape(f)->getOrder() == 1);
+
+  this->addEvaluatedField(w);
+  if (! is_side) this->addEvaluatedField(grad_w);
+  this->addEvaluatedField(wdv);
+  this->setName("Cached Basis");
+}
+
+PHX_POST_REGISTRATION_SETUP(CachedBasis, data, fm) {
+  this->utils.setFieldData(w, fm);
+  if (! is_side) this->utils.setFieldData(grad_w, fm);
+  this->utils.setFieldData(wdv, fm);
+  (void)data;
+}
+
+template <typename EVALT, typename TRAITS>
+void CachedBasis<EVALT, TRAITS>::compute_reference(apf::MeshEntity* e) {
+  apf::Vector3 xi;
+  apf::NewArray<double> N;
+  auto mesh = apf::getMesh(field->get_apf_field());
+  auto me = apf::createMeshElement(mesh, e);
+  auto fe = apf::createElement(field->get_apf_field(), me);
+  ref_w.resize(num_nodes * num_ips);
+  ref_weights.resize(num_ips);
+  for (int ip = 0; ip < num_ips; ++ip) {
+    apf::getIntPoint(me, q_degree, ip, xi);
+    apf::getShapeValues(fe, xi, N);
+    for (int node = 0; node < num_nodes; ++node)
+      ref_w[node * num_ips + ip] = N[node];
+    ref_weights[ip] = apf::getIntWeight(me, q_degree, ip);
+  }
+  apf::destroyElement(fe);
+  apf::destroyMeshElement(me);
+  has_reference = true;
+}
+
+template <typename EVALT, typename TRAITS>
+void CachedBasis<EVALT, TRAITS>::compute_block(
+    apf::MeshEntity* const* ents, int size, BasisCache::Block& b) {
+  apf::Vector3 xi;
+  apf::NewArray<apf::Vector3> dN;
+  auto mesh = apf::getMesh(field->get_apf_field());
+  int num_pts = is_affine ? 1 : num_ips;
+  if (! is_side) b.grad_w.resize(size * num_nodes * num_pts * num_dims);
+  b.dv.resize(size * num_pts);
+  for (int elem = 0; elem < size; ++elem) {
+    auto me = apf::createMeshElement(mesh, ents[elem]);
+    auto fe = apf::createElement(field->get_apf_field(), me);
+    for (int pt = 0; pt < num_pts; ++pt) {
+      apf::getIntPoint(me, q_degree, pt, xi);
+      b.dv[elem * num_pts + pt] = apf::getDV(me, xi);
+      if (is_side) continue;
+      apf::getShapeGrads(fe, xi, dN);
+      for (int node = 0; node < num_nodes; ++node)
+      for (int dim = 0; dim < num_dims; ++dim) {
+        int idx = ((elem * num_nodes + node) * num_pts + pt) * num_dims + dim;
+        b.grad_w[idx] = dN[node][dim];
+      }
+    }
+    apf::destroyElement(fe);
+    apf::destroyMeshElement(me);
+  }
+}
+
+template <typename EVALT, typename TRAITS>
+void CachedBasis<EVALT, TRAITS>::fill(
+    BasisCache::Block const& b, int size) {
+  int num_pts = is_affine ? 1 : num_ips;
+  for (int elem = 0; elem < size; ++elem)
+  for (int ip = 0; ip < num_ips; ++ip) {
+    int pt = is_affine ? 0 : ip;
+    wdv(elem, ip) = ref_weights[ip] * b.dv[elem * num_pts + pt];
+    for (int node = 0; node < num_nodes; ++node) {
+      w(elem, node, ip) = ref_w[node * num_ips + ip];
+      if (is_side) continue;
+      for (int dim = 0; dim < num_dims; ++dim) {
+        int idx = ((elem * num_nodes + node) * num_pts + pt) * num_dims + dim;
+        grad_w(elem, node, ip, dim) = b.grad_w[idx];
+      }
+    }
+  }
+}
+
+PHX_EVALUATE_FIELDS(CachedBasis, workset) {
+  if (workset.size == 0) return;
+  auto first = workset.entities[0];
+  if (! has_reference) compute_reference(first);
+
+  // reuse the stored block of this workset
+  auto stored = cache->find(set, workset.size, first);
+  if (stored) {
+    fill(*stored, workset.size);
+    return;
+  }
+
+  // otherwise compute it, and store it if it fits under the cap
+  BasisCache::Block b;
+  compute_block(&workset.entities[0], workset.size, b);
+  cache->insert(set, workset.size, first, b);
+  fill(b, workset.size);
+}
+
+template class CachedBasis<goal::Traits::Residual, goal::Traits>;
+template class CachedBasis<goal::Traits::Jacobian, goal::Traits>;
+
+} // end namespace ml
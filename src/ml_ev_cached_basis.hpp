@@ -0,0 +1,69 @@
+#ifndef ml_ev_cached_basis_hpp
+#define ml_ev_cached_basis_hpp
+
+/// @file ml_ev_cached_basis.hpp
+
+#include <Phalanx_Evaluator_Macros.hpp>
+#include <goal_dimension.hpp>
+#include "ml_basis_cache.hpp"
+
+/// @cond
+namespace goal {
+class Field;
+}
+/// @endcond
+
+namespace ml {
+
+PHX_EVALUATOR_CLASS(CachedBasis)
+
+  public:
+
+    /// @brief Construct the cached basis evaluator.
+    /// @param u The displacement field the basis belongs to.
+    /// @param c The cache to keep the reference basis data in.
+    /// @param set A unique id of the element or side set.
+    /// @param type The entity type to operate on.
+    /// @details This evaluates the same basis values, basis gradients
+    /// and weighted differential volumes as goal::Basis. The basis
+    /// values are computed once per entity type, and the gradients and
+    /// volumes once per workset through the \ref ml::BasisCache. The
+    /// gradients are not evaluated on sides.
+    CachedBasis(goal::Field* u, BasisCache* c, int set, int type);
+
+  private:
+
+    using Node = goal::Node;
+    using Dim = goal::Dim;
+    using Ent = goal::Ent;
+    using IP = goal::IP;
+
+    void compute_reference(apf::MeshEntity* e);
+    void compute_block(
+        apf::MeshEntity* const* ents, int size, BasisCache::Block& b);
+    void fill(BasisCache::Block const& b, int size);
+
+    goal::Field* field;
+    BasisCache* cache;
+    int set;
+    bool is_side;
+    bool is_affine;
+    bool has_reference;
+
+    int num_nodes;
+    int num_ips;
+    int num_dims;
+    int q_degree;
+    std::vector<double> ref_w;
+    std::vector<double> ref_weights;
+
+    // output
+    PHX::MDField<double, Ent, Node, IP> w;
+    PHX::MDField<double, Ent, Node, IP, Dim> grad_w;
+    PHX::MDField<double, Ent, IP> wdv;
+
+PHX_EVALUATOR_CLASS_END
+
+} // end namespace ml
+
+#endif
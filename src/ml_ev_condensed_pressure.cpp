@@ -0,0 +1,131 @@
+#include <apf.h>
+#include <apfMesh.h>
+#include <goal_control.hpp>
+#include <goal_field.hpp>
+#include <goal_indexer.hpp>
+#include <goal_traits.hpp>
+#include <goal_workset.hpp>
+#include <Teuchos_SerialDenseMatrix.hpp>
+#include <Teuchos_SerialDenseSolver.hpp>
+
+#include "ml_ev_condensed_pressure.hpp"
+
+namespace ml {
+
+using DenseSolver = Teuchos::SerialDenseSolver<int, double>;
+
+template <typename EVALT, typename TRAITS>
+CondensedPressure<EVALT, TRAITS>::CondensedPressure(
+    std::vector<goal::Field*> const& u,
+    goal::Indexer* i,
+    int degree,
+    int type)
+    : indexer(i),
+      wdv(u[0]->wdv_name(), u[0]->ip0_dl(type)),
+      cauchy("cauchy", u[0]->ip2_dl(type)),
+      pressure("p", u[0]->ip0_dl(type)) {
+
+  num_ips = u[0]->get_num_ips(type);
+  num_dims = u[0]->get_num_dims();
+  q_degree = u[0]->get_q_degree();
+  monomials = get_monomials(num_dims, degree);
+  GOAL_DEBUG_ASSERT(num_dims == (int)u.size());
+
+  this->addDependentField(wdv);
+  this->addDependentField(cauchy);
+  this->addEvaluatedField(pressure);
+  this->setName("Condensed Pressure");
+}
+
+PHX_POST_REGISTRATION_SETUP(CondensedPressure, data, fm) {
+  this->utils.setFieldData(wdv, fm);
+  this->utils.setFieldData(cauchy, fm);
+  this->utils.setFieldData(pressure, fm);
+  (void)data;
+}
+
+template <typename EVALT, typename TRAITS>
+void CondensedPressure<EVALT, TRAITS>::build_projection(
+    apf::MeshEntity* e, int elem, DenseMatrix& P) {
+
+  // the pressure basis in scaled element coordinates
+  apf::Vector3 x;
+  apf::Vector3 xi;
+  auto mesh = indexer->get_apf_mesh();
+  int num_coeffs = monomials.size();
+  DenseMatrix phi(num_ips, num_coeffs);
+  auto me = apf::createMeshElement(mesh, e);
+  auto center = apf::getLinearCentroid(mesh, e);
+  auto h = std::pow(apf::measure(me), 1.0 / num_dims);
+  for (int ip = 0; ip < num_ips; ++ip) {
+    apf::getIntPoint(me, q_degree, ip, xi);
+    apf::mapLocalToGlobal(me, xi, x);
+    auto xs = (x - center) / h;
+    for (int a = 0; a < num_coeffs; ++a)
+      phi(ip, a) = eval_monomial(monomials[a], xs);
+  }
+  apf::destroyMeshElement(me);
+
+  // invert the element pressure mass matrix
+  DenseMatrix M(num_coeffs, num_coeffs);
+  DenseMatrix Minv(num_coeffs, num_coeffs);
+  DenseMatrix I(num_coeffs, num_coeffs);
+  for (int a = 0; a < num_coeffs; ++a) {
+    I(a, a) = 1.0;
+    for (int b = 0; b < num_coeffs; ++b)
+    for (int ip = 0; ip < num_ips; ++ip)
+      M(a, b) += phi(ip, a) * phi(ip, b) * wdv(elem, ip);
+  }
+  DenseSolver solver;
+  solver.setMatrix(Teuchos::rcpFromRef(M));
+  solver.setVectors(Teuchos::rcpFromRef(Minv), Teuchos::rcpFromRef(I));
+  solver.factorWithEquilibration(true);
+  if (solver.solve() != 0)
+    goal::fail("condensed pressure: singular element mass matrix");
+
+  // the L2 projection from integration point values to ip values
+  P.shape(num_ips, num_ips);
+  for (int ip = 0; ip < num_ips; ++ip)
+  for (int jp = 0; jp < num_ips; ++jp)
+  for (int a = 0; a < num_coeffs; ++a)
+  for (int b = 0; b < num_coeffs; ++b)
+    P(ip, jp) += phi(ip, a) * Minv(a, b) * phi(jp, b) * wdv(elem, jp);
+}
+
+PHX_EVALUATE_FIELDS(CondensedPressure, workset) {
+
+  std::vector<ScalarT> pbar(num_ips);
+
+  for (int elem = 0; elem < workset.size; ++elem) {
+
+    // the constitutive pressure at the integration points
+    for (int ip = 0; ip < num_ips; ++ip) {
+      pbar[ip] = 0.0;
+      for (int i = 0; i < num_dims; ++i)
+        pbar[ip] += cauchy(elem, ip, i, i);
+      pbar[ip] /= num_dims;
+    }
+
+    // the projection depends only on the reference element, so it is
+    // built on the first evaluation and kept with the model
+    auto e = workset.entities[elem];
+    auto it = projections.find(e);
+    if (it == projections.end()) {
+      it = projections.insert(std::make_pair(e, DenseMatrix())).first;
+      build_projection(e, elem, it->second);
+    }
+    auto& P = it->second;
+
+    // project the constitutive pressure onto the pressure space
+    for (int ip = 0; ip < num_ips; ++ip) {
+      pressure(elem, ip) = 0.0;
+      for (int jp = 0; jp < num_ips; ++jp)
+        pressure(elem, ip) += P(ip, jp) * pbar[jp];
+    }
+  }
+}
+
+template class CondensedPressure<goal::Traits::Residual, goal::Traits>;
+template class CondensedPressure<goal::Traits::Jacobian, goal::Traits>;
+
+} // end namespace ml
@@ -0,0 +1,77 @@
+#ifndef ml_ev_condensed_pressure_hpp
+#define ml_ev_condensed_pressure_hpp
+
+/// @file ml_ev_condensed_pressure.hpp
+
+#include <map>
+#include <Phalanx_Evaluator_Macros.hpp>
+#include <Teuchos_SerialDenseMatrix.hpp>
+#include <goal_dimension.hpp>
+
+#include "ml_polynomial.hpp"
+
+/// @cond
+namespace apf {
+class MeshEntity;
+}
+
+namespace goal {
+class Field;
+class Indexer;
+}
+/// @endcond
+
+namespace ml {
+
+PHX_EVALUATOR_CLASS(CondensedPressure)
+
+  public:
+
+    /// @brief Construct the condensed pressure evaluator.
+    /// @param u The displacement fields.
+    /// @param i The linear algebra indexer.
+    /// @param degree The polynomial degree of the pressure space.
+    /// @param type The entity type to operate on.
+    /// @details The pressure is discontinuous and of the given degree
+    /// on each element. The pressure equation is solved on each element
+    /// as the local L2 projection of the constitutive pressure. This
+    /// statically condenses the pressure out of the global system, so
+    /// only the displacement DOFs remain. The pressure p is evaluated
+    /// at the integration points only and has no field of its own.
+    /// The projection depends only on the reference element, so it is
+    /// kept for each element for the lifetime of the evaluator.
+    CondensedPressure(
+        std::vector<goal::Field*> const& u,
+        goal::Indexer* i,
+        int degree,
+        int type);
+
+  private:
+
+    using Ent = goal::Ent;
+    using IP = goal::IP;
+    using Dim = goal::Dim;
+    using DenseMatrix = Teuchos::SerialDenseMatrix<int, double>;
+
+    void build_projection(apf::MeshEntity* e, int elem, DenseMatrix& P);
+
+    goal::Indexer* indexer;
+
+    int num_ips;
+    int num_dims;
+    int q_degree;
+    std::vector<Monomial> monomials;
+    std::map<apf::MeshEntity*, DenseMatrix> projections;
+
+    // input
+    PHX::MDField<const double, Ent, IP> wdv;
+    PHX::MDField<const ScalarT, Ent, IP, Dim, Dim> cauchy;
+
+    // output
+    PHX::MDField<ScalarT, Ent, IP> pressure;
+
+PHX_EVALUATOR_CLASS_END
+
+} // end namespace ml
+
+#endif
@@ -1,6 +1,5 @@
 #include <goal_control.hpp>
 #include <goal_field.hpp>
-#include <goal_states.hpp>
 #include <goal_traits.hpp>
 #include <goal_workset.hpp>
 #include <Teuchos_ParameterList.hpp>
@@ -14,17 +13,16 @@ static ParameterList get_valid_params() {
   p.set<double>("E", 0.0);
   p.set<double>("nu", 0.0);
   p.set<double>("alpha", 0.0);
+  p.set<double>("rho", 0.0);
   return p;
 }
 
 template <typename EVALT, typename TRAITS>
 Elastic<EVALT, TRAITS>::Elastic(
     std::vector<goal::Field*> const& u,
-    goal::States* s,
     ParameterList const& mp,
     int type)
-    : states(s),
-      cauchy("cauchy", u[0]->ip2_dl(type)) {
+    : cauchy("cauchy", u[0]->ip2_dl(type)) {
 
   num_dims = u[0]->get_num_dims();
   num_ips = u[0]->get_num_ips(type);
@@ -63,7 +61,6 @@ PHX_EVALUATE_FIELDS(Elastic, workset) {
   double lambda = E * nu / ((1.0 + nu) * (1.0 - 2.0 * nu));
 
   for (int elem = 0; elem < workset.size; ++elem) {
-    auto e = workset.entities[elem];
     for (int ip = 0; ip < num_ips; ++ip) {
 
       for (int i = 0; i < num_dims; ++i)
@@ -74,8 +71,6 @@ PHX_EVALUATE_FIELDS(Elastic, workset) {
       for (int i = 0; i < num_dims; ++i)
       for (int j = 0; j < num_dims; ++j)
         cauchy(elem, ip, i, j) = sigma(i, j);
-
-      states->set_tensor("cauchy", e, ip, sigma);
     }
   }
 }
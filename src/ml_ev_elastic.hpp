@@ -13,7 +13,6 @@ class ParameterList;
 
 namespace goal {
 class Field;
-class States;
 }
 /// @endcond
 
@@ -27,12 +26,10 @@ PHX_EVALUATOR_CLASS(Elastic)
 
     /// @brief Construct the elastic stress evaluator.
     /// @param u The displacement fields.
-    /// @param s The state fields structure.
     /// @param mp A parameter list of material properties.
     /// @param type The entity type to operate on.
     Elastic(
         std::vector<goal::Field*> const& u,
-        goal::States* s,
         ParameterList const& mp,
         int type);
 
@@ -47,7 +44,6 @@ PHX_EVALUATOR_CLASS(Elastic)
     
     double E;
     double nu;
-    goal::States* states;
 
     // input
     std::vector<PHX::MDField<const ScalarT, Ent, IP, Dim> > grad_u;
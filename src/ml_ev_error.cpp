@@ -0,0 +1,66 @@
+#include <apf.h>
+#include <goal_control.hpp>
+#include <goal_field.hpp>
+#include <goal_states.hpp>
+#include <goal_traits.hpp>
+#include <goal_workset.hpp>
+#include <MiniTensor.h>
+#include <Phalanx_DataLayout_MDALayout.hpp>
+
+#include "ml_ev_error.hpp"
+
+namespace ml {
+
+using Teuchos::rcp;
+
+template <typename EVALT, typename TRAITS>
+ErrorIndicator<EVALT, TRAITS>::ErrorIndicator(
+    std::vector<goal::Field*> const& u,
+    goal::States* s,
+    apf::Field* e,
+    int type)
+    : states(s),
+      error(e),
+      wdv(u[0]->wdv_name(), u[0]->ip0_dl(type)),
+      stress("first_pk", u[0]->ip2_dl(type)) {
+
+  num_ips = u[0]->get_num_ips(type);
+  num_dims = u[0]->get_num_dims();
+  GOAL_DEBUG_ASSERT(num_dims == (int)u.size());
+
+  auto name = "Error Indicator";
+  PHX::Tag<ScalarT> op(name, rcp(new PHX::MDALayout<Dummy>(0)));
+
+  this->addDependentField(wdv);
+  this->addDependentField(stress);
+  this->addEvaluatedField(op);
+  this->setName(name);
+}
+
+PHX_POST_REGISTRATION_SETUP(ErrorIndicator, data, fm) {
+  this->utils.setFieldData(wdv, fm);
+  this->utils.setFieldData(stress, fm);
+  (void)data;
+}
+
+PHX_EVALUATE_FIELDS(ErrorIndicator, workset) {
+  minitensor::Tensor<double> grad_dz(num_dims);
+
+  for (int elem = 0; elem < workset.size; ++elem) {
+    auto e = workset.entities[elem];
+    ScalarT eta = 0.0;
+    for (int ip = 0; ip < num_ips; ++ip) {
+      states->get_tensor("grad_dz", e, ip, grad_dz);
+      for (int i = 0; i < num_dims; ++i)
+      for (int j = 0; j < num_dims; ++j)
+        eta -= stress(elem, ip, i, j) * grad_dz(i, j) * wdv(elem, ip);
+    }
+    double value = Sacado::ScalarValue<ScalarT>::eval(eta);
+    apf::setScalar(error, e, 0, apf::getScalar(error, e, 0) + value);
+  }
+}
+
+template class ErrorIndicator<goal::Traits::Residual, goal::Traits>;
+template class ErrorIndicator<goal::Traits::Jacobian, goal::Traits>;
+
+} // end namespace ml
@@ -0,0 +1,65 @@
+#ifndef ml_ev_error_hpp
+#define ml_ev_error_hpp
+
+/// @file ml_ev_error.hpp
+
+#include <Phalanx_Evaluator_Macros.hpp>
+#include <goal_dimension.hpp>
+
+/// @cond
+namespace apf {
+class Field;
+}
+
+namespace goal {
+class Field;
+class States;
+}
+/// @endcond
+
+namespace ml {
+
+PHX_EVALUATOR_CLASS(ErrorIndicator)
+
+  public:
+
+    /// @brief Construct the error indicator evaluator.
+    /// @param u The displacement fields.
+    /// @param s The state fields structure.
+    /// @param e The element-wise error field to fill in.
+    /// @param type The entity type to operate on.
+    /// @details This adds the volume part of the element-wise dual
+    /// weighted residual
+    /// \f$ \eta_e = -\int_{\Omega_e} P : \nabla (z^+ - z_h) \, dV \f$
+    /// to the error field, where the weight gradient has been stored in
+    /// the state "grad_dz" by \ref ml::recover_dual_weights. The traction
+    /// part is added by \ref ml::TractionError, so that the indicators
+    /// sum to \f$ F(z^+ - z_h) - a(u_h, z^+ - z_h) \f$.
+    ErrorIndicator(
+        std::vector<goal::Field*> const& u,
+        goal::States* s,
+        apf::Field* e,
+        int type);
+
+  private:
+
+    using Dummy = goal::Dummy;
+    using Ent = goal::Ent;
+    using IP = goal::IP;
+    using Dim = goal::Dim;
+
+    int num_ips;
+    int num_dims;
+
+    goal::States* states;
+    apf::Field* error;
+
+    // input
+    PHX::MDField<const double, Ent, IP> wdv;
+    PHX::MDField<const ScalarT, Ent, IP, Dim, Dim> stress;
+
+PHX_EVALUATOR_CLASS_END
+
+} // end namespace ml
+
+#endif
@@ -11,7 +11,7 @@ namespace ml {
 template <typename EVALT, typename TRAITS>
 FirstPK<EVALT, TRAITS>::FirstPK(
     std::vector<goal::Field*> const& u,
-    goal::Field* p,
+    bool mixed,
     bool small,
     int type)
     : def_grad("F", u[0]->ip2_dl(type)),
@@ -24,12 +24,11 @@ FirstPK<EVALT, TRAITS>::FirstPK(
   GOAL_DEBUG_ASSERT(num_dims == (int)u.size());
 
   small_strain = small;
-  have_pressure = (p) ? true : false;
+  have_pressure = mixed;
 
   if (have_pressure) {
-    auto n = p->name();
-    auto dl = p->ip_dl(type);
-    pressure = PHX::MDField<const ScalarT, Ent, IP>(n, dl);
+    auto dl = u[0]->ip0_dl(type);
+    pressure = PHX::MDField<const ScalarT, Ent, IP>("p", dl);
     this->addDependentField(pressure);
   }
 
@@ -20,12 +20,13 @@ PHX_EVALUATOR_CLASS(FirstPK)
 
     /// @brief Construct the first Piola-Kirchhoff evaluator.
     /// @param u The displacement fields.
-    /// @param p The (optional) pressure field.
+    /// @param mixed True if the condensed pressure p should replace
+    /// the pressure of the Cauchy stress.
     /// @param small True if small strain should be used.
     /// @param type The entity type to operate on.
     FirstPK(
         std::vector<goal::Field*> const& u,
-        goal::Field* p,
+        bool mixed,
         bool small,
         int type);
 
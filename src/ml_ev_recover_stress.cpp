@@ -0,0 +1,62 @@
+#include <goal_control.hpp>
+#include <goal_field.hpp>
+#include <goal_traits.hpp>
+#include <goal_workset.hpp>
+#include <Phalanx_DataLayout_MDALayout.hpp>
+
+#include "ml_ev_recover_stress.hpp"
+#include "ml_stress_output.hpp"
+
+namespace ml {
+
+using Teuchos::rcp;
+
+template <typename EVALT, typename TRAITS>
+RecoverStress<EVALT, TRAITS>::RecoverStress(
+    std::vector<goal::Field*> const& u,
+    StressOutput* s,
+    int type)
+    : stress(s),
+      wdv(u[0]->wdv_name(), u[0]->ip0_dl(type)),
+      cauchy("cauchy", u[0]->ip2_dl(type)) {
+
+  num_ips = u[0]->get_num_ips(type);
+  num_dims = u[0]->get_num_dims();
+  GOAL_DEBUG_ASSERT(num_dims == (int)u.size());
+
+  auto name = "Recover Stress";
+  PHX::Tag<ScalarT> op(name, rcp(new PHX::MDALayout<Dummy>(0)));
+
+  this->addDependentField(wdv);
+  this->addDependentField(cauchy);
+  this->addEvaluatedField(op);
+  this->setName(name);
+}
+
+PHX_POST_REGISTRATION_SETUP(RecoverStress, data, fm) {
+  this->utils.setFieldData(wdv, fm);
+  this->utils.setFieldData(cauchy, fm);
+  (void)data;
+}
+
+PHX_EVALUATE_FIELDS(RecoverStress, workset) {
+  if (! stress->is_active()) return;
+  std::vector<double> w(num_ips);
+  std::vector<minitensor::Tensor<double> > sigma(
+      num_ips, minitensor::Tensor<double>(num_dims));
+  for (int elem = 0; elem < workset.size; ++elem) {
+    for (int ip = 0; ip < num_ips; ++ip) {
+      w[ip] = wdv(elem, ip);
+      for (int i = 0; i < num_dims; ++i)
+      for (int j = 0; j < num_dims; ++j)
+        sigma[ip](i, j) =
+          Sacado::ScalarValue<ScalarT>::eval(cauchy(elem, ip, i, j));
+    }
+    stress->add(workset.entities[elem], sigma, w);
+  }
+}
+
+template class RecoverStress<goal::Traits::Residual, goal::Traits>;
+template class RecoverStress<goal::Traits::Jacobian, goal::Traits>;
+
+} // end namespace ml
@@ -0,0 +1,56 @@
+#ifndef ml_ev_recover_stress_hpp
+#define ml_ev_recover_stress_hpp
+
+/// @file ml_ev_recover_stress.hpp
+
+#include <Phalanx_Evaluator_Macros.hpp>
+#include <goal_dimension.hpp>
+
+/// @cond
+namespace goal {
+class Field;
+}
+/// @endcond
+
+namespace ml {
+
+/// @cond
+class StressOutput;
+/// @endcond
+
+PHX_EVALUATOR_CLASS(RecoverStress)
+
+  public:
+
+    /// @brief Construct the stress recovery evaluator.
+    /// @param u The displacement fields.
+    /// @param s The stress output fields to fill in.
+    /// @param type The entity type to operate on.
+    /// @details This does nothing unless a stress recovery pass has been
+    /// started with \ref ml::StressOutput::begin.
+    RecoverStress(
+        std::vector<goal::Field*> const& u,
+        StressOutput* s,
+        int type);
+
+  private:
+
+    using Dummy = goal::Dummy;
+    using Ent = goal::Ent;
+    using IP = goal::IP;
+    using Dim = goal::Dim;
+
+    int num_ips;
+    int num_dims;
+
+    StressOutput* stress;
+
+    // input
+    PHX::MDField<const double, Ent, IP> wdv;
+    PHX::MDField<const ScalarT, Ent, IP, Dim, Dim> cauchy;
+
+PHX_EVALUATOR_CLASS_END
+
+} // end namespace ml
+
+#endif
@@ -0,0 +1,79 @@
+#include <apf.h>
+#include <apfMesh.h>
+#include <goal_control.hpp>
+#include <goal_field.hpp>
+#include <goal_traits.hpp>
+#include <goal_workset.hpp>
+#include <Phalanx_DataLayout_MDALayout.hpp>
+
+#include "ml_ev_traction_error.hpp"
+
+namespace ml {
+
+using Teuchos::rcp;
+
+template <typename EVALT, typename TRAITS>
+TractionError<EVALT, TRAITS>::TractionError(
+    std::vector<goal::Field*> const& u,
+    Teuchos::Array<std::string> const& array,
+    apf::MeshTag* t,
+    apf::Field* e,
+    int type)
+    : bc(array),
+      tag(t),
+      error(e),
+      wdv(u[0]->wdv_name(), u[0]->ip0_dl(type)) {
+
+  num_ips = u[0]->get_num_ips(type);
+  num_dims = u[0]->get_num_dims();
+  q_degree = u[0]->get_q_degree();
+
+  GOAL_DEBUG_ASSERT(num_dims == (int)u.size());
+  GOAL_DEBUG_ASSERT(bc.size() == (num_dims + 1));
+
+  auto name = "Traction Error: " + bc[0];
+  PHX::Tag<ScalarT> op(name, rcp(new PHX::MDALayout<Dummy>(0)));
+
+  this->addDependentField(wdv);
+  this->addEvaluatedField(op);
+  this->setName(name);
+}
+
+PHX_POST_REGISTRATION_SETUP(TractionError, data, fm) {
+  this->utils.setFieldData(wdv, fm);
+  (void)data;
+}
+
+PHX_EVALUATE_FIELDS(TractionError, workset) {
+  apf::Vector3 x(0, 0, 0);
+  apf::Vector3 xi(0, 0, 0);
+  apf::Vector3 traction(0, 0, 0);
+
+  auto t = workset.t_now;
+  auto mesh = apf::getMesh(error);
+  std::vector<double> dz(num_ips * num_dims);
+
+  for (int side = 0; side < workset.size; ++side) {
+    auto s = workset.entities[side];
+    if ((! tag) || (! mesh->hasTag(s, tag))) continue;
+    mesh->getDoubleTag(s, tag, &(dz[0]));
+    auto me = apf::createMeshElement(mesh, s);
+    double eta = 0.0;
+    for (int ip = 0; ip < num_ips; ++ip) {
+      apf::getIntPoint(me, q_degree, ip, xi);
+      apf::mapLocalToGlobal(me, xi, x);
+      for (int i = 0; i < num_dims; ++i)
+        traction[i] = goal::eval(bc[i+1], x[0], x[1], x[2], t);
+      for (int i = 0; i < num_dims; ++i)
+        eta += traction[i] * dz[ip * num_dims + i] * wdv(side, ip);
+    }
+    apf::destroyMeshElement(me);
+    auto elem = mesh->getUpward(s, 0);
+    apf::setScalar(error, elem, 0, apf::getScalar(error, elem, 0) + eta);
+  }
+}
+
+template class TractionError<goal::Traits::Residual, goal::Traits>;
+template class TractionError<goal::Traits::Jacobian, goal::Traits>;
+
+} // end namespace ml
@@ -0,0 +1,64 @@
+#ifndef ml_ev_traction_error_hpp
+#define ml_ev_traction_error_hpp
+
+/// @file ml_ev_traction_error.hpp
+
+#include <Phalanx_Evaluator_Macros.hpp>
+#include <goal_dimension.hpp>
+
+/// @cond
+namespace apf {
+class Field;
+class MeshTag;
+}
+
+namespace goal {
+class Field;
+}
+/// @endcond
+
+namespace ml {
+
+PHX_EVALUATOR_CLASS(TractionError)
+
+  public:
+
+    /// @brief Construct the traction error indicator evaluator.
+    /// @param u The displacement fields.
+    /// @param bc The traction boundary condition array.
+    /// @param t The side tag of dual weights from
+    /// \ref ml::find_side_weights.
+    /// @param e The element-wise error field to add to.
+    /// @param type The entity type to operate on.
+    /// @details This adds the traction part of the dual weighted
+    /// residual, \f$ \int_{\Gamma_e} t \cdot (z^+ - z_h) \, dA \f$, to
+    /// the error of the element adjacent to each side.
+    TractionError(
+        std::vector<goal::Field*> const& u,
+        Teuchos::Array<std::string> const& bc,
+        apf::MeshTag* t,
+        apf::Field* e,
+        int type);
+
+  private:
+
+    using Dummy = goal::Dummy;
+    using Ent = goal::Ent;
+    using IP = goal::IP;
+
+    Teuchos::Array<std::string> bc;
+    apf::MeshTag* tag;
+    apf::Field* error;
+
+    int num_ips;
+    int num_dims;
+    int q_degree;
+
+    // input
+    PHX::MDField<const double, Ent, IP> wdv;
+
+PHX_EVALUATOR_CLASS_END
+
+} // end namespace ml
+
+#endif
@@ -0,0 +1,164 @@
+#include <cmath>
+#include <goal_assembly.hpp>
+#include <goal_control.hpp>
+#include <goal_dbcs.hpp>
+#include <goal_discretization.hpp>
+#include <goal_indexer.hpp>
+#include <goal_output.hpp>
+#include <goal_sol_info.hpp>
+#include <PCU.h>
+
+#include "ml_async_output.hpp"
+#include "ml_explicit_solver.hpp"
+#include "ml_linear_algebra.hpp"
+#include "ml_mass.hpp"
+#include "ml_mechanics.hpp"
+#include "ml_startup.hpp"
+#include "ml_stress_output.hpp"
+
+namespace ml {
+
+static ParameterList get_valid_params() {
+  ParameterList p;
+  p.set<std::string>("solver type", "");
+  p.set<double>("final time", 0.0);
+  p.set<double>("cfl", 0.0);
+  p.set<int>("output interval", 0);
+  p.sublist("discretization");
+  p.sublist("mechanics");
+  p.sublist("output");
+  p.sublist("time series");
+  return p;
+}
+
+static void validate_params(ParameterList const& p) {
+  GOAL_ALWAYS_ASSERT(p.isSublist("discretization"));
+  GOAL_ALWAYS_ASSERT(p.isSublist("mechanics"));
+  GOAL_ALWAYS_ASSERT(p.isSublist("output"));
+  GOAL_ALWAYS_ASSERT(p.isType<double>("final time"));
+  p.validateParameters(get_valid_params(), 0);
+}
+
+ExplicitSolver::ExplicitSolver(ParameterList const& p)
+    : params(p),
+      disc(0),
+      mech(0),
+      info(0),
+      out(0),
+      series(0) {
+  validate_params(params);
+  params.get<double>("cfl", 0.5);
+  params.get<int>("output interval", 0);
+  auto dp = params.sublist("discretization");
+  auto mp = params.sublist("mechanics");
+  auto op = params.sublist("output");
+  disc = ml::create_disc(dp);
+  out = goal::create_output(op, disc);
+  mech = ml::create_mech(mp, disc);
+  if (params.isSublist("time series"))
+    series = ml::create_async_output(params.sublist("time series"), disc);
+}
+
+ExplicitSolver::~ExplicitSolver() {
+  if (info) {
+    mech->destroy_model();
+    goal::destroy_sol_info(info);
+    mech->destroy_indexer();
+  }
+  if (series) ml::destroy_async_output(series);
+  ml::destroy_mech(mech);
+  goal::destroy_output(out);
+  goal::destroy_disc(disc);
+}
+
+void ExplicitSolver::build_data() {
+  auto t0 = PCU_Time();
+  mech->build_coarse_indexer();
+  info = goal::create_sol_info(mech->get_indexer(), 0);
+  mech->build_primal_model();
+
+  // only residuals are assembled, so the jacobians are released and the
+  // dirichlet rows are found from the dirichlet conditions themselves
+  info->owned->dRdu = Teuchos::null;
+  info->ghost->dRdu = Teuchos::null;
+  auto dbc_rows = get_dbc_rows(mech, info, 0.0);
+  goal::set_dbc_values(mech, 0.0);
+
+  // dirichlet dofs get a zero inverse mass and so never accelerate
+  auto mass = ml::compute_lumped_mass(mech, info, disc);
+  auto map = mass->getMap();
+  inv_mass = Teuchos::rcp(new goal::Vector(map));
+  inv_mass->reciprocal(*mass);
+  {
+    auto inv = inv_mass->getDataNonConst();
+    auto is_dbc = dbc_rows->getData();
+    for (size_t i = 0; i < inv_mass->getLocalLength(); ++i)
+      if (is_dbc[i] != 0.0) inv[i] = 0.0;
+  }
+  a = Teuchos::rcp(new goal::Vector(map));
+  v = Teuchos::rcp(new goal::Vector(map));
+  auto t1 = PCU_Time();
+  goal::print(" > num dofs: %lu", map->getGlobalNumElements());
+  goal::print(" > setup time: %f seconds", t1 - t0);
+}
+
+void ExplicitSolver::compute_acceleration(
+    double t, double dt, bool is_output) {
+  auto stress = mech->get_stress_output();
+  bool recover = is_output && stress;
+  if (recover) stress->begin();
+  goal::compute_primal_residual(mech, info, disc, t, dt);
+  if (recover) stress->end();
+  a->elementWiseMultiply(-1.0, *inv_mass, *(info->owned->R), 0.0);
+}
+
+void ExplicitSolver::write_output(int step, double t) {
+  if (series) series->write(step, t);
+  else out->write(t);
+}
+
+void ExplicitSolver::solve() {
+  goal::print("solving");
+  build_data();
+
+  // choose a stable time step that lands on the final time
+  auto final_time = params.get<double>("final time");
+  auto cfl = params.get<double>("cfl");
+  auto interval = params.get<int>("output interval");
+  auto dt_crit = ml::compute_critical_time_step(mech, disc);
+  int num_steps = std::max(1, (int)std::ceil(final_time / (cfl * dt_crit)));
+  double dt = final_time / num_steps;
+  goal::print(" > critical time step: %e", dt_crit);
+  goal::print(" > time step: %e", dt);
+  goal::print(" > num steps: %d", num_steps);
+
+  // initial conditions are at rest
+  double t = 0.0;
+  auto u = mech->get_u();
+  auto du = info->owned->du;
+  auto indexer = mech->get_indexer();
+  v->putScalar(0.0);
+  compute_acceleration(t, dt, true);
+  write_output(0, t);
+
+  // velocity form of the central difference method
+  auto t0 = PCU_Time();
+  for (int step = 1; step <= num_steps; ++step) {
+    v->update(0.5 * dt, *a, 1.0);
+    du->update(dt, *v, 0.0);
+    indexer->add_to_fields(u, du);
+    t = step * dt;
+    goal::set_dbc_values(mech, t);
+    bool is_output = (step == num_steps);
+    if (interval > 0) is_output = is_output || (step % interval == 0);
+    compute_acceleration(t, dt, is_output);
+    v->update(0.5 * dt, *a, 1.0);
+    mech->update_history();
+    if (is_output) write_output(step, t);
+  }
+  auto t1 = PCU_Time();
+  goal::print(" > time integration: %f seconds", t1 - t0);
+  goal::print(" > time per step: %e seconds", (t1 - t0) / num_steps);
+}
+
+} // end namespace ml
@@ -0,0 +1,68 @@
+#ifndef ml_explicit_solver_hpp
+#define ml_explicit_solver_hpp
+
+/// @file ml_explicit_solver.hpp
+
+#include <goal_data_types.hpp>
+#include <Teuchos_ParameterList.hpp>
+#include "ml_solver.hpp"
+
+/// @cond
+namespace goal {
+class Discretization;
+class SolInfo;
+class Output;
+}
+/// @endcond
+
+namespace ml {
+
+using Teuchos::ParameterList;
+
+/// @cond
+class Mechanics;
+class AsyncOutput;
+/// @endcond
+
+/// @brief An explicit central difference dynamics solver.
+/// @details Each step of the velocity form of the central difference
+/// method evaluates the internal force once with the primal residual
+/// evaluators and divides by the lumped mass from
+/// \ref ml::compute_lumped_mass. There is no Jacobian assembly and no
+/// linear solve per step. The time step is the critical time step from
+/// \ref ml::compute_critical_time_step scaled by the `cfl` factor.
+class ExplicitSolver : public Solver {
+
+  public:
+
+    /// @brief Construct the explicit solver.
+    /// @param p The full parameter list describing this solver.
+    ExplicitSolver(ParameterList const& p);
+
+    /// @brief Destroy the explicit solver.
+    ~ExplicitSolver();
+
+    /// @brief Run the solver.
+    void solve();
+
+  private:
+
+    void build_data();
+    void compute_acceleration(double t, double dt, bool is_output);
+    void write_output(int step, double t);
+
+    ParameterList params;
+    goal::Discretization* disc;
+    ml::Mechanics* mech;
+    goal::SolInfo* info;
+    goal::Output* out;
+    ml::AsyncOutput* series;
+
+    Teuchos::RCP<goal::Vector> inv_mass;
+    Teuchos::RCP<goal::Vector> a;
+    Teuchos::RCP<goal::Vector> v;
+};
+
+} // end namespace ml
+
+#endif
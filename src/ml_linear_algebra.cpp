@@ -0,0 +1,416 @@
+#include <cmath>
+#include <limits>
+#include <map>
+#include <apf.h>
+#include <apfMesh.h>
+#include <apfShape.h>
+#include <goal_control.hpp>
+#include <goal_dbcs.hpp>
+#include <goal_field.hpp>
+#include <goal_indexer.hpp>
+#include <goal_sol_info.hpp>
+#include <PCU.h>
+#include <Tpetra_RowMatrixTransposer.hpp>
+
+#include "ml_linear_algebra.hpp"
+#include "ml_mechanics.hpp"
+
+namespace ml {
+
+Teuchos::RCP<goal::Vector> get_dbc_rows(
+    Teuchos::RCP<goal::Matrix> A) {
+  // rows with dirichlet conditions are identity rows of the jacobian
+  size_t n = 0;
+  Teuchos::Array<goal::LO> cols(A->getNodeMaxNumRowEntries());
+  Teuchos::Array<goal::ST> vals(A->getNodeMaxNumRowEntries());
+  auto dbc_rows = Teuchos::rcp(new goal::Vector(A->getRowMap()));
+  auto is_dbc = dbc_rows->getDataNonConst();
+  auto row_map = A->getRowMap();
+  auto col_map = A->getColMap();
+  for (size_t row = 0; row < A->getNodeNumRows(); ++row) {
+    A->getLocalRowCopy(row, cols(), vals(), n);
+    auto gid = row_map->getGlobalElement(row);
+    bool identity = true;
+    for (size_t j = 0; j < n; ++j) {
+      bool diag = (col_map->getGlobalElement(cols[j]) == gid);
+      if ((diag && vals[j] != 1.0) || (! diag && vals[j] != 0.0))
+        identity = false;
+    }
+    is_dbc[row] = (identity) ? 1.0 : 0.0;
+  }
+  return dbc_rows;
+}
+
+// op(ent, node, n) visits the n-th node owned by ent, which is the
+// node-th node of its closure
+template <typename Op>
+static void apply_to_nodes(apf::Field* f, Op const& op) {
+  apf::MeshEntity* ent;
+  auto mesh = apf::getMesh(f);
+  auto shape = apf::getShape(f);
+  for (int d = 0; d <= mesh->getDimension(); ++d) {
+    if (! shape->hasNodesIn(d)) continue;
+    auto it = mesh->begin(d);
+    while ((ent = mesh->iterate(it))) {
+      auto type = mesh->getType(ent);
+      int num_own = shape->countNodesOn(type);
+      int num_nodes = shape->getEntityShape(type)->countNodes();
+      for (int n = 0; n < num_own; ++n)
+        op(ent, num_nodes - num_own + n, n);
+    }
+    mesh->end(it);
+  }
+}
+
+Teuchos::RCP<goal::Vector> get_dbc_rows(
+    Mechanics* m,
+    goal::SolInfo* info,
+    double t) {
+
+  // dirichlet nodes are the nodes set_dbc_values writes to, found by
+  // filling the fields with nan beforehand
+  std::vector<double> saved;
+  auto u = m->get_u();
+  auto indexer = m->get_indexer();
+  auto nan = std::numeric_limits<double>::quiet_NaN();
+  for (size_t c = 0; c < u.size(); ++c) {
+    auto f = u[c]->get_apf_field();
+    apply_to_nodes(f, [&] (apf::MeshEntity* e, int, int n) {
+      saved.push_back(apf::getScalar(f, e, n));
+      apf::setScalar(f, e, n, nan);
+    });
+  }
+  goal::set_dbc_values(m, t);
+
+  // mark the ghost rows of the written nodes and restore the fields
+  size_t offset = 0;
+  auto ghost = Teuchos::rcp(new goal::Vector(info->ghost->R->getMap()));
+  auto g = ghost->getDataNonConst();
+  for (size_t c = 0; c < u.size(); ++c) {
+    auto f = u[c]->get_apf_field();
+    apply_to_nodes(f, [&] (apf::MeshEntity* e, int node, int n) {
+      if (! std::isnan(apf::getScalar(f, e, n)))
+        g[indexer->get_ghost_lid(c, e, node)] = 1.0;
+      apf::setScalar(f, e, n, saved[offset++]);
+    });
+  }
+
+  // a row is a dirichlet row if any rank marked it
+  auto owned_map = info->owned->R->getMap();
+  auto dbc_rows = Teuchos::rcp(new goal::Vector(owned_map));
+  goal::Export exporter(ghost->getMap(), owned_map);
+  dbc_rows->doExport(*ghost, exporter, Tpetra::ABSMAX);
+  return dbc_rows;
+}
+
+Teuchos::RCP<goal::Matrix> get_transpose(
+    Teuchos::RCP<goal::Matrix> A,
+    Teuchos::RCP<goal::Vector> dbc_rows) {
+
+  // form the transpose of the primal jacobian without re-assembly
+  using Transposer = Tpetra::RowMatrixTransposer<
+    goal::ST, goal::LO, goal::GO, goal::KNode>;
+  Transposer transposer(A);
+  auto AT = transposer.createTranspose();
+
+  // restore identity rows for the homogeneous dual dirichlet conditions
+  size_t n = 0;
+  Teuchos::Array<goal::LO> cols(AT->getNodeMaxNumRowEntries());
+  Teuchos::Array<goal::ST> vals(AT->getNodeMaxNumRowEntries());
+  auto is_dbc = dbc_rows->getData();
+  auto dbc_map = dbc_rows->getMap();
+  auto row_map = AT->getRowMap();
+  auto col_map = AT->getColMap();
+  AT->resumeFill();
+  for (size_t row = 0; row < AT->getNodeNumRows(); ++row) {
+    auto gid = row_map->getGlobalElement(row);
+    if (is_dbc[dbc_map->getLocalElement(gid)] == 0.0) continue;
+    AT->getLocalRowCopy(row, cols(), vals(), n);
+    for (size_t j = 0; j < n; ++j)
+      vals[j] = (col_map->getGlobalElement(cols[j]) == gid) ? 1.0 : 0.0;
+    AT->replaceLocalValues(row, cols(0, n), vals(0, n));
+  }
+  AT->fillComplete(A->getRangeMap(), A->getDomainMap());
+  return AT;
+}
+
+struct NodeDOF {
+  apf::MeshEntity* ent;
+  int node;
+  goal::LO lid;
+  int component;
+  apf::Vector3 x;
+};
+
+static void get_node_point(
+    apf::Mesh* mesh,
+    apf::MeshEntity* ent,
+    apf::FieldShape* shape,
+    int node,
+    apf::Vector3& x) {
+  if (mesh->getType(ent) == apf::Mesh::VERTEX) {
+    mesh->getPoint(ent, 0, x);
+    return;
+  }
+  apf::Vector3 xi;
+  shape->getNodeXi(mesh->getType(ent), node, xi);
+  auto me = apf::createMeshElement(mesh, ent);
+  apf::mapLocalToGlobal(me, xi, x);
+  apf::destroyMeshElement(me);
+}
+
+static std::vector<NodeDOF> get_owned_node_dofs(
+    Mechanics* m,
+    goal::SolInfo* info) {
+
+  // the nodes of an entity are the trailing nodes of its closure
+  std::vector<NodeDOF> dofs;
+  auto indexer = m->get_indexer();
+  auto u = m->get_u();
+  auto mesh = indexer->get_apf_mesh();
+  auto shape = apf::getShape(u[0]->get_apf_field());
+  auto ghost_map = info->ghost->R->getMap();
+  auto owned_map = info->owned->R->getMap();
+  auto invalid = Teuchos::OrdinalTraits<goal::LO>::invalid();
+  for (int d = 0; d <= mesh->getDimension(); ++d) {
+    apf::MeshEntity* ent;
+    auto it = mesh->begin(d);
+    while ((ent = mesh->iterate(it))) {
+      auto type = mesh->getType(ent);
+      int num_own = shape->countNodesOn(type);
+      if (num_own == 0) continue;
+      int num_nodes = shape->getEntityShape(type)->countNodes();
+      for (int k = 0; k < num_own; ++k) {
+        NodeDOF dof;
+        get_node_point(mesh, ent, shape, k, dof.x);
+        dof.ent = ent;
+        dof.node = k;
+        int node = num_nodes - num_own + k;
+        for (size_t c = 0; c < u.size(); ++c) {
+          auto lid = indexer->get_ghost_lid(c, ent, node);
+          auto gid = ghost_map->getGlobalElement(lid);
+          dof.lid = owned_map->getLocalElement(gid);
+          dof.component = c;
+          if (dof.lid != invalid) dofs.push_back(dof);
+        }
+      }
+    }
+    mesh->end(it);
+  }
+  return dofs;
+}
+
+Teuchos::RCP<MultiVector> build_rigid_body_modes(
+    Mechanics* m,
+    goal::SolInfo* info) {
+
+  // center the rotations about the mean node location
+  auto dofs = get_owned_node_dofs(m, info);
+  auto dim = m->get_u().size();
+  double sums[4] = {0.0, 0.0, 0.0, 0.0};
+  for (size_t i = 0; i < dofs.size(); ++i) {
+    if (dofs[i].component != 0) continue;
+    for (int j = 0; j < 3; ++j)
+      sums[j] += dofs[i].x[j];
+    sums[3] += 1.0;
+  }
+  PCU_Add_Doubles(sums, 4);
+  GOAL_ALWAYS_ASSERT(sums[3] > 0.0);
+  apf::Vector3 center(sums[0], sums[1], sums[2]);
+  center = center / sums[3];
+
+  // translations followed by the infinitesimal rotations
+  int num_modes = (dim == 2) ? 3 : 6;
+  auto owned_map = info->owned->R->getMap();
+  auto modes = Teuchos::rcp(new MultiVector(owned_map, num_modes));
+  for (size_t i = 0; i < dofs.size(); ++i) {
+    auto lid = dofs[i].lid;
+    auto c = dofs[i].component;
+    auto x = dofs[i].x - center;
+    modes->replaceLocalValue(lid, c, 1.0);
+    if (c == 0) modes->replaceLocalValue(lid, dim, -x[1]);
+    if (c == 1) modes->replaceLocalValue(lid, dim, x[0]);
+    if (dim == 2) continue;
+    if (c == 1) modes->replaceLocalValue(lid, 4, -x[2]);
+    if (c == 2) modes->replaceLocalValue(lid, 4, x[1]);
+    if (c == 0) modes->replaceLocalValue(lid, 5, x[2]);
+    if (c == 2) modes->replaceLocalValue(lid, 5, -x[0]);
+  }
+  return modes;
+}
+
+Teuchos::RCP<MultiVector> restrict_rows(
+    Teuchos::RCP<MultiVector> v,
+    Teuchos::RCP<const Map> map) {
+  auto num_vecs = v->getNumVectors();
+  auto v_map = v->getMap();
+  auto r = Teuchos::rcp(new MultiVector(map, num_vecs));
+  for (size_t j = 0; j < num_vecs; ++j) {
+    auto vj = v->getData(j);
+    auto rj = r->getDataNonConst(j);
+    for (size_t lid = 0; lid < map->getNodeNumElements(); ++lid) {
+      auto v_lid = v_map->getLocalElement(map->getGlobalElement(lid));
+      GOAL_DEBUG_ASSERT(v_lid != Teuchos::OrdinalTraits<goal::LO>::invalid());
+      rj[lid] = vj[v_lid];
+    }
+  }
+  return r;
+}
+
+void add_to_diagonal(
+    Teuchos::RCP<goal::Matrix> A,
+    Teuchos::RCP<goal::Vector> d,
+    double s) {
+  auto dv = d->getData();
+  auto row_map = A->getRowMap();
+  auto col_map = A->getColMap();
+  A->resumeFill();
+  for (size_t row = 0; row < A->getNodeNumRows(); ++row) {
+    if (dv[row] == 0.0) continue;
+    goal::LO col = col_map->getLocalElement(row_map->getGlobalElement(row));
+    goal::ST val = s * dv[row];
+    A->sumIntoLocalValues(row, Teuchos::arrayView(&col, 1),
+        Teuchos::arrayView(&val, 1));
+  }
+  A->fillComplete(A->getDomainMap(), A->getRangeMap());
+}
+
+Teuchos::RCP<goal::Matrix> restrict_rows(
+    Teuchos::RCP<goal::Matrix> A,
+    Teuchos::RCP<const Map> map) {
+  size_t n = 0;
+  auto max = A->getNodeMaxNumRowEntries();
+  Teuchos::Array<goal::GO> cols(max);
+  Teuchos::Array<goal::ST> vals(max);
+  auto R = Teuchos::rcp(new goal::Matrix(map, max));
+  for (size_t lid = 0; lid < map->getNodeNumElements(); ++lid) {
+    auto gid = map->getGlobalElement(lid);
+    A->getGlobalRowCopy(gid, cols(), vals(), n);
+    R->insertGlobalValues(gid, cols(0, n), vals(0, n));
+  }
+  R->fillComplete(A->getDomainMap(), map);
+  return R;
+}
+
+Teuchos::RCP<goal::Matrix> build_p1_prolongation(
+    Mechanics* m,
+    goal::SolInfo* info) {
+
+  // the coarse dofs are the vertex dofs of the fine fields
+  GOAL_ALWAYS_ASSERT(m->get_p_order() > 1);
+  auto dofs = get_owned_node_dofs(m, info);
+  auto indexer = m->get_indexer();
+  auto mesh = indexer->get_apf_mesh();
+  auto shape = apf::getShape(m->get_u()[0]->get_apf_field());
+  auto linear = apf::getLagrange(1);
+  auto ghost_map = info->ghost->R->getMap();
+  auto owned_map = info->owned->R->getMap();
+  Teuchos::Array<goal::GO> coarse_gids;
+  for (size_t i = 0; i < dofs.size(); ++i)
+    if (mesh->getType(dofs[i].ent) == apf::Mesh::VERTEX)
+      coarse_gids.push_back(owned_map->getGlobalElement(dofs[i].lid));
+  auto num = Teuchos::OrdinalTraits<Tpetra::global_size_t>::invalid();
+  auto base = owned_map->getIndexBase();
+  auto comm = owned_map->getComm();
+  auto coarse_map = Teuchos::rcp(new Map(num, coarse_gids(), base, comm));
+
+  // interpolate the linear field at the fine lagrange nodes
+  apf::Vector3 xi;
+  apf::NewArray<double> values;
+  apf::Downward verts;
+  auto P = Teuchos::rcp(new goal::Matrix(owned_map, 0));
+  for (size_t i = 0; i < dofs.size(); ++i) {
+    auto ent = dofs[i].ent;
+    auto c = dofs[i].component;
+    auto row = owned_map->getGlobalElement(dofs[i].lid);
+    Teuchos::Array<goal::GO> cols;
+    Teuchos::Array<goal::ST> vals;
+    if (mesh->getType(ent) == apf::Mesh::VERTEX) {
+      cols.push_back(row);
+      vals.push_back(1.0);
+    } else {
+      auto type = mesh->getType(ent);
+      int num_verts = mesh->getDownward(ent, 0, verts);
+      shape->getNodeXi(type, dofs[i].node, xi);
+      linear->getEntityShape(type)->getValues(mesh, ent, xi, values);
+      for (int v = 0; v < num_verts; ++v) {
+        auto lid = indexer->get_ghost_lid(c, verts[v], 0);
+        cols.push_back(ghost_map->getGlobalElement(lid));
+        vals.push_back(values[v]);
+      }
+    }
+    P->insertGlobalValues(row, cols(), vals());
+  }
+  P->fillComplete(coarse_map, owned_map);
+  return P;
+}
+
+Teuchos::RCP<goal::Vector> build_node_block_ids(
+    Mechanics* m,
+    goal::SolInfo* info) {
+
+  // number the owned nodes contiguously across the ranks
+  using Node = std::pair<apf::MeshEntity*, int>;
+  std::map<Node, long> nodes;
+  auto dofs = get_owned_node_dofs(m, info);
+  for (size_t i = 0; i < dofs.size(); ++i) {
+    Node node(dofs[i].ent, dofs[i].node);
+    if (! nodes.count(node)) nodes[node] = long(nodes.size());
+  }
+  long offset = nodes.size();
+  PCU_Exscan_Longs(&offset, 1);
+
+  // interleave the components of each node
+  long dim = m->get_u().size();
+  auto ids = Teuchos::rcp(new goal::Vector(info->owned->R->getMap()));
+  auto values = ids->getDataNonConst();
+  for (size_t i = 0; i < dofs.size(); ++i) {
+    Node node(dofs[i].ent, dofs[i].node);
+    values[dofs[i].lid] = (offset + nodes[node]) * dim + dofs[i].component;
+  }
+  return ids;
+}
+
+std::vector<apf::Field*> save_to_fields(
+    Mechanics* m,
+    goal::SolInfo* info,
+    Teuchos::RCP<goal::Vector> v,
+    std::string const& name) {
+  std::vector<apf::Field*> f;
+  auto u = m->get_u();
+  auto mesh = apf::getMesh(u[0]->get_apf_field());
+  auto shape = apf::getShape(u[0]->get_apf_field());
+  for (size_t c = 0; c < u.size(); ++c) {
+    auto fname = name + "_" + std::to_string(c);
+    f.push_back(apf::createField(mesh, fname.c_str(), apf::SCALAR, shape));
+    apf::zeroField(f[c]);
+  }
+  auto dofs = get_owned_node_dofs(m, info);
+  auto values = v->getData();
+  for (size_t i = 0; i < dofs.size(); ++i) {
+    auto& dof = dofs[i];
+    apf::setScalar(f[dof.component], dof.ent, dof.node, values[dof.lid]);
+  }
+  for (size_t c = 0; c < f.size(); ++c)
+    apf::synchronize(f[c]);
+  return f;
+}
+
+Teuchos::RCP<goal::Vector> load_from_fields(
+    Mechanics* m,
+    goal::SolInfo* info,
+    std::vector<apf::Field*> const& f) {
+  GOAL_ALWAYS_ASSERT(f.size() == m->get_u().size());
+  auto v = Teuchos::rcp(new goal::Vector(info->owned->R->getMap()));
+  auto dofs = get_owned_node_dofs(m, info);
+  auto values = v->getDataNonConst();
+  for (size_t i = 0; i < dofs.size(); ++i) {
+    auto& dof = dofs[i];
+    values[dof.lid] = apf::getScalar(f[dof.component], dof.ent, dof.node);
+  }
+  for (size_t c = 0; c < f.size(); ++c)
+    apf::destroyField(f[c]);
+  return v;
+}
+
+} // end namespace ml
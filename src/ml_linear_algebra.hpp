@@ -0,0 +1,151 @@
+#ifndef ml_linear_algebra_hpp
+#define ml_linear_algebra_hpp
+
+/// @file ml_linear_algebra.hpp
+
+#include <goal_data_types.hpp>
+#include <Tpetra_MultiVector.hpp>
+#include <Tpetra_Operator.hpp>
+
+/// @cond
+namespace apf {
+class Field;
+}
+
+namespace goal {
+class SolInfo;
+}
+/// @endcond
+
+namespace ml {
+
+/// @cond
+class Mechanics;
+/// @endcond
+
+/// @brief Tpetra map type.
+using Map = Tpetra::Map<goal::LO, goal::GO, goal::KNode>;
+
+/// @brief Tpetra multivector type.
+using MultiVector =
+  Tpetra::MultiVector<goal::ST, goal::LO, goal::GO, goal::KNode>;
+
+/// @brief Tpetra operator type.
+using Operator = Tpetra::Operator<goal::ST, goal::LO, goal::GO, goal::KNode>;
+
+/// @brief Find the rows of a Jacobian with Dirichlet conditions.
+/// @param A The owned Jacobian with Dirichlet conditions applied.
+/// @returns A vector with a value of 1 at Dirichlet rows and 0 elsewhere.
+/// @details Dirichlet rows are identified as identity rows of A.
+Teuchos::RCP<goal::Vector> get_dbc_rows(Teuchos::RCP<goal::Matrix> A);
+
+/// @brief Find the Dirichlet rows without a Jacobian.
+/// @param m The mechanics object whose Dirichlet conditions are used.
+/// @param i The solution information built on the primal indexer.
+/// @param t The time to evaluate the Dirichlet conditions at.
+/// @returns A vector with a value of 1 at Dirichlet rows and 0 elsewhere.
+/// @details Dirichlet rows are the DOFs of the nodes written by
+/// goal::set_dbc_values. The displacement fields are left unchanged.
+Teuchos::RCP<goal::Vector> get_dbc_rows(
+    Mechanics* m,
+    goal::SolInfo* i,
+    double t);
+
+/// @brief Form the transpose of a Jacobian for the dual problem.
+/// @param A The owned Jacobian with Dirichlet conditions applied.
+/// @param dbc_rows The Dirichlet rows as given by \ref ml::get_dbc_rows.
+/// @details The Dirichlet rows of the transpose are reset to identity
+/// rows, which imposes homogeneous Dirichlet conditions on the dual.
+Teuchos::RCP<goal::Matrix> get_transpose(
+    Teuchos::RCP<goal::Matrix> A,
+    Teuchos::RCP<goal::Vector> dbc_rows);
+
+/// @brief Build the rigid body modes of the displacement fields.
+/// @param m The mechanics object whose indexer numbers the DOFs.
+/// @param i The solution information built on the primal indexer.
+/// @returns A multivector on the owned map with the 3 (2D) or 6 (3D)
+/// translations and infinitesimal rotations as columns.
+/// @details Rotations are taken about the global mean of the node
+/// coordinates to keep the modes well conditioned.
+Teuchos::RCP<MultiVector> build_rigid_body_modes(
+    Mechanics* m,
+    goal::SolInfo* i);
+
+/// @brief Restrict the rows of a multivector to a sub-map.
+/// @param v The multivector to restrict.
+/// @param map A map whose global ids are a subset of those of v.
+Teuchos::RCP<MultiVector> restrict_rows(
+    Teuchos::RCP<MultiVector> v,
+    Teuchos::RCP<const Map> map);
+
+/// @brief Add a scaled vector to the diagonal of a matrix.
+/// @param A The fill complete owned matrix to modify.
+/// @param d The vector to add, on the row map of A.
+/// @param s The scale factor applied to d.
+/// @details Rows where d is zero are left untouched.
+void add_to_diagonal(
+    Teuchos::RCP<goal::Matrix> A,
+    Teuchos::RCP<goal::Vector> d,
+    double s);
+
+/// @brief Restrict the rows of a matrix to a sub-map.
+/// @param A The fill complete matrix to restrict.
+/// @param map A map whose global ids are a subset of the rows of A.
+/// @details The domain map of the result is the domain map of A.
+Teuchos::RCP<goal::Matrix> restrict_rows(
+    Teuchos::RCP<goal::Matrix> A,
+    Teuchos::RCP<const Map> map);
+
+/// @brief Build the prolongation from p1 to the displacement order.
+/// @param m The mechanics object whose indexer numbers the DOFs.
+/// @param i The solution information built on the primal indexer.
+/// @returns A matrix whose domain map holds the vertex DOFs and whose
+/// range map is the owned DOF map.
+/// @details Each row interpolates the linear field at a Lagrange node
+/// from the vertices of the entity the node is classified on. The p1
+/// coarse DOFs share their global ids with the vertex DOFs.
+Teuchos::RCP<goal::Matrix> build_p1_prolongation(
+    Mechanics* m,
+    goal::SolInfo* i);
+
+/// @brief Number the DOFs node by node.
+/// @param m The mechanics object whose indexer numbers the DOFs.
+/// @param i The solution information built on the primal indexer.
+/// @returns An owned vector holding, for each DOF, the global id
+/// \f$ n d + c \f$ of the DOF in a node-major ordering, where \f$ n \f$
+/// is the global node id, \f$ d \f$ the number of displacement
+/// components and \f$ c \f$ the component of the DOF.
+/// @details The nodes are numbered contiguously across the ranks in
+/// the order of the owned DOFs.
+Teuchos::RCP<goal::Vector> build_node_block_ids(
+    Mechanics* m,
+    goal::SolInfo* i);
+
+/// @brief Save an owned DOF vector to standalone nodal fields.
+/// @param m The mechanics object whose indexer numbers the DOFs.
+/// @param i The solution information built on the primal indexer.
+/// @param v The owned vector to save.
+/// @param name The name prefix of the fields.
+/// @returns One field per displacement component, with the shape of
+/// the displacement fields and synchronized across part boundaries.
+/// @details The fields outlive the indexer and move with the mesh
+/// entities when the mesh is migrated.
+std::vector<apf::Field*> save_to_fields(
+    Mechanics* m,
+    goal::SolInfo* i,
+    Teuchos::RCP<goal::Vector> v,
+    std::string const& name);
+
+/// @brief Load an owned DOF vector from standalone nodal fields.
+/// @param m The mechanics object whose indexer numbers the DOFs.
+/// @param i The solution information built on the primal indexer.
+/// @param f The fields returned by \ref ml::save_to_fields.
+/// @details The fields f are destroyed afterwards.
+Teuchos::RCP<goal::Vector> load_from_fields(
+    Mechanics* m,
+    goal::SolInfo* i,
+    std::vector<apf::Field*> const& f);
+
+} // end namespace ml
+
+#endif
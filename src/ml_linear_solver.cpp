@@ -0,0 +1,233 @@
+#include <BelosLinearProblem.hpp>
+#include <BelosSolverFactory.hpp>
+#include <BelosTpetraAdapter.hpp>
+#include <goal_control.hpp>
+#include <goal_linear_solvers.hpp>
+#include <MueLu_CreateTpetraPreconditioner.hpp>
+#include <PCU.h>
+
+#include "ml_block_storage.hpp"
+#include "ml_linear_solver.hpp"
+#include "ml_memory.hpp"
+#ifdef ML_HAVE_SINGLE_PRECISION
+#include "ml_mixed_precision.hpp"
+#endif
+#include "ml_pmultigrid.hpp"
+
+namespace ml {
+
+using Problem = Belos::LinearProblem<goal::ST, MultiVector, Operator>;
+using Factory = Belos::SolverFactory<goal::ST, MultiVector, Operator>;
+
+LinearSolver::LinearSolver(ParameterList const& p, bool v)
+    : params(p),
+      verbose(v),
+      is_single(false),
+      is_recycled(false),
+      reuse(false),
+      is_reported(false),
+      track_memory(false),
+      block_size(0),
+      num_iters(0),
+      storage("crs"),
+      coarse(0) {
+  is_amg = params.isSublist("amg");
+  is_pmg = params.isSublist("p-multigrid");
+  if (params.isType<std::string>("preconditioner precision")) {
+    auto precision = params.get<std::string>("preconditioner precision");
+    if ((precision != "double") && (precision != "single"))
+      goal::fail("unknown preconditioner precision %s", precision.c_str());
+    is_single = (precision == "single");
+#ifndef ML_HAVE_SINGLE_PRECISION
+    if (is_single)
+      goal::fail("single precision needs float support in Tpetra");
+#endif
+  }
+  GOAL_ALWAYS_ASSERT(is_amg || (! is_single));
+  if (params.isType<std::string>("matrix storage"))
+    storage = params.get<std::string>("matrix storage");
+  if ((storage != "crs") && (storage != "bsr") && (storage != "symmetric"))
+    goal::fail("unknown matrix storage %s", storage.c_str());
+  GOAL_ALWAYS_ASSERT(is_amg || is_pmg || (storage == "crs"));
+  is_recycled = params.isType<int>("recycle size");
+  if (! (is_amg || is_pmg || is_recycled)) return;
+  GOAL_ALWAYS_ASSERT(! (is_amg && is_pmg));
+  GOAL_ALWAYS_ASSERT(params.isType<std::string>("method"));
+  GOAL_ALWAYS_ASSERT(params.isType<int>("maximum iterations"));
+  GOAL_ALWAYS_ASSERT(params.isType<double>("tolerance"));
+  if (is_recycled) {
+    auto method = params.get<std::string>("method");
+    if ((method != "GCRODR") && (method != "RCG"))
+      goal::fail("krylov recycling needs GCRODR or RCG, not %s",
+          method.c_str());
+    GOAL_ALWAYS_ASSERT(params.get<int>("recycle size") > 0);
+    GOAL_ALWAYS_ASSERT(params.isType<int>("krylov size"));
+  }
+  if (is_amg) {
+    auto& amg = params.sublist("amg");
+    amg.get<std::string>("multigrid algorithm", "sa");
+    amg.get<std::string>("verbosity", "none");
+  }
+  if (is_pmg) {
+    auto& pmg = params.sublist("p-multigrid");
+    GOAL_ALWAYS_ASSERT(pmg.isSublist("coarse"));
+    pmg.get<std::string>("smoother", "chebyshev");
+    coarse = new LinearSolver(pmg.sublist("coarse"), false);
+    coarse->set_preconditioner_reuse(true);
+  }
+}
+
+LinearSolver::~LinearSolver() {
+  delete coarse;
+}
+
+void LinearSolver::set_null_space(Teuchos::RCP<MultiVector> ns) {
+  reset_preconditioner();
+  null_space = ns;
+  if (coarse) coarse->set_null_space(ns);
+}
+
+void LinearSolver::set_prolongation(Teuchos::RCP<goal::Matrix> P) {
+  reset_preconditioner();
+  prolongation = P;
+}
+
+void LinearSolver::set_node_blocks(
+    Teuchos::RCP<goal::Vector> ids, int dim) {
+  reset_preconditioner();
+  node_ids = ids;
+  block_size = dim;
+}
+
+Teuchos::RCP<MultiVector> LinearSolver::get_null_space(
+    Teuchos::RCP<const Map> map) {
+  if (null_space.is_null()) return null_space;
+  if (null_space->getMap()->isSameAs(*map)) return null_space;
+  return restrict_rows(null_space, map);
+}
+
+Teuchos::RCP<goal::Matrix> LinearSolver::get_prolongation(
+    Teuchos::RCP<const Map> map) {
+  GOAL_ALWAYS_ASSERT(Teuchos::nonnull(prolongation));
+  if (prolongation->getRangeMap()->isSameAs(*map)) return prolongation;
+  return restrict_rows(prolongation, map);
+}
+
+Teuchos::RCP<Operator> LinearSolver::get_operator(
+    Teuchos::RCP<goal::Matrix> A) {
+  if (node_ids.is_null()) return A;
+  bool is_kept = reuse && Teuchos::nonnull(op) && (op_matrix == A);
+  if (is_kept) return op;
+  auto map = A->getRowMap();
+  auto ids = node_ids;
+  if (! ids->getMap()->isSameAs(*map))
+    ids = restrict_rows(node_ids, map)->getVectorNonConst(0);
+  bool is_symmetric = (storage == "symmetric");
+  auto block_op = Teuchos::rcp(
+      new NodeBlockOperator(A, ids, block_size, is_symmetric));
+  if (verbose && (! is_reported)) block_op->report();
+  is_reported = true;
+  op_matrix = A;
+  op = block_op;
+  return op;
+}
+
+Teuchos::RCP<Operator> LinearSolver::build_preconditioner(
+    Teuchos::RCP<goal::Matrix> A) {
+  Teuchos::RCP<Operator> M;
+  if (is_amg) {
+    auto amg = params.sublist("amg");
+    auto ns = get_null_space(A->getRowMap());
+    Teuchos::RCP<Operator> A_op = A;
+#ifdef ML_HAVE_SINGLE_PRECISION
+    if (is_single) M = Teuchos::rcp(new SinglePrecisionAMG(amg, A, ns));
+#endif
+    if (! is_single)
+      M = MueLu::CreateTpetraPreconditioner(A_op, amg, Teuchos::null, ns);
+  }
+  if (is_pmg) {
+    auto pmg = params.sublist("p-multigrid");
+    auto P = get_prolongation(A->getRowMap());
+    M = Teuchos::rcp(new PMultigrid(pmg, A, P, coarse));
+  }
+  return M;
+}
+
+void LinearSolver::solve_krylov(
+    Teuchos::RCP<goal::Matrix> A,
+    Teuchos::RCP<goal::Vector> x,
+    Teuchos::RCP<goal::Vector> b) {
+
+  // build or reuse the preconditioner
+  auto t0 = PCU_Time();
+  bool is_kept = reuse && Teuchos::nonnull(prec) && (prec_matrix == A);
+  if (! is_kept) prec = build_preconditioner(A);
+  prec_matrix = A;
+  auto M = prec;
+  auto t1 = PCU_Time();
+  if (track_memory && (! is_kept))
+    print_memory("linear solver setup");
+
+  // solve with the preconditioned krylov method
+  auto method = params.get<std::string>("method");
+  auto solver = get_krylov_solver(A->getRowMap());
+  auto problem = Teuchos::rcp(new Problem(get_operator(A), x, b));
+  if ((method == "CG") || (method == "RCG")) problem->setLeftPrec(M);
+  else problem->setRightPrec(M);
+  problem->setProblem();
+  solver->setProblem(problem);
+  auto result = solver->solve();
+  auto t2 = PCU_Time();
+  if (! reuse) reset_preconditioner();
+  num_iters += solver->getNumIters();
+
+  if (result != Belos::Converged)
+    goal::print(" > warning: linear solve did not converge");
+  if (! verbose) return;
+  goal::print(" > preconditioner setup time: %f seconds", t1 - t0);
+  goal::print(" > linear solve: %d iterations in %f seconds",
+      solver->getNumIters(), t2 - t1);
+}
+
+Teuchos::RCP<LinearSolver::Krylov> LinearSolver::get_krylov_solver(
+    Teuchos::RCP<const Map> map) {
+
+  // keep the recycling solver, and with it the recycled subspace, as
+  // long as the systems are posed on the same map
+  bool is_kept = Teuchos::nonnull(recycler) && map->isSameAs(*recycle_map);
+  if (is_kept) return recycler;
+  auto method = params.get<std::string>("method");
+  auto bp = Teuchos::rcp(new ParameterList);
+  bp->set<int>("Maximum Iterations", params.get<int>("maximum iterations"));
+  bp->set<double>("Convergence Tolerance", params.get<double>("tolerance"));
+  if (params.isType<int>("krylov size"))
+    bp->set<int>("Num Blocks", params.get<int>("krylov size"));
+  if (is_recycled)
+    bp->set<int>("Num Recycled Blocks", params.get<int>("recycle size"));
+  Factory factory;
+  auto solver = factory.create(method, bp);
+  if (! is_recycled) return solver;
+  recycler = solver;
+  recycle_map = map;
+  return solver;
+}
+
+void LinearSolver::solve(
+    Teuchos::RCP<goal::Matrix> A,
+    Teuchos::RCP<goal::Vector> x,
+    Teuchos::RCP<goal::Vector> b,
+    goal::Indexer* i) {
+  if (is_amg || is_pmg || is_recycled) solve_krylov(A, x, b);
+  else if (i) goal::solve_linear_system(params, A, x, b, i);
+  else goal::solve_linear_system(params, A, x, b);
+}
+
+LinearSolver* create_linear_solver(ParameterList const& p) {
+  return new LinearSolver(p);
+}
+
+void destroy_linear_solver(LinearSolver* s) {
+  delete s;
+}
+
+} // end namespace ml
@@ -0,0 +1,178 @@
+#ifndef ml_linear_solver_hpp
+#define ml_linear_solver_hpp
+
+/// @file ml_linear_solver.hpp
+
+#include <BelosSolverManager.hpp>
+#include <Teuchos_ParameterList.hpp>
+#include "ml_linear_algebra.hpp"
+
+/// @cond
+namespace goal {
+class Indexer;
+}
+/// @endcond
+
+namespace ml {
+
+using Teuchos::ParameterList;
+
+/// @brief The linear solver used by the MechLab solvers.
+/// @details Without a preconditioner sublist in the linear algebra
+/// parameters this defers to goal::solve_linear_system. Otherwise a
+/// Belos Krylov method is preconditioned by one of:
+///
+/// - `amg`: smoothed aggregation AMG from MueLu, built with the rigid
+/// body modes of the displacement fields as the near null space. The
+/// sublist is handed to MueLu as is, with `multigrid algorithm: sa`
+/// and `verbosity: none` as defaults. With `preconditioner precision`
+/// set to `single` (default `double`), the hierarchy is built from a
+/// single precision copy of the matrix by \ref ml::SinglePrecisionAMG.
+///
+/// - `p-multigrid`: a \ref ml::PMultigrid V-cycle with the p1
+/// discretization as the coarse level. The `smoother` is `chebyshev`
+/// (default) or `jacobi`, with optional Ifpack2 `smoother params`, and
+/// the `coarse` sublist describes the coarse level linear solver.
+///
+/// With a preconditioner, the `matrix storage` of the Krylov operator
+/// can be `crs` (default), the node-blocked `bsr` or the node-blocked
+/// `symmetric` storage of \ref ml::NodeBlockOperator. The
+/// preconditioner is always built from the assembled CRS matrix. The
+/// node-blocked operator is a copy built in addition to the assembled
+/// CRS matrix, so it adds matrix memory rather than saving it. Like the
+/// preconditioner, it is kept across the solves with one matrix fill
+/// when the preconditioner is reused, and rebuilt otherwise.
+///
+/// With a `recycle size`, the Belos `GCRODR` or `RCG` method keeps that
+/// many approximate eigenvectors of the smallest eigenvalues across
+/// solves, such as successive Newton iterations and load steps, and
+/// deflates them from the next solve. The subspace is kept as long as
+/// the systems are posed on the same map. This also applies without a
+/// preconditioner sublist.
+class LinearSolver {
+
+  public:
+
+    /// @brief Construct the linear solver.
+    /// @param p The linear algebra parameter list.
+    /// @param v Whether to print setup times and iteration counts.
+    LinearSolver(ParameterList const& p, bool v = true);
+
+    /// @brief Destroy the linear solver.
+    ~LinearSolver();
+
+    /// @brief Returns true if the solver uses a near null space.
+    bool needs_null_space() { return is_amg || is_pmg; }
+
+    /// @brief Returns true if the solver uses a p1 prolongation.
+    bool needs_prolongation() { return is_pmg; }
+
+    /// @brief Returns true if the solver uses node-blocked storage.
+    bool needs_node_blocks() { return storage != "crs"; }
+
+    /// @brief Returns true if the Krylov operator assumes symmetry.
+    bool is_symmetric() { return storage == "symmetric"; }
+
+    /// @brief Set the node-blocked DOF ids for the Krylov operator.
+    /// @param ids The ids of \ref ml::build_node_block_ids on the full
+    /// owned DOF map.
+    /// @param dim The number of DOFs per node.
+    void set_node_blocks(Teuchos::RCP<goal::Vector> ids, int dim);
+
+    /// @brief Set the near null space for the preconditioner.
+    /// @param ns The near null space on the full owned DOF map.
+    /// @details Systems posed on a subset of the DOFs, such as
+    /// condensed skeleton systems, use the restricted rows.
+    void set_null_space(Teuchos::RCP<MultiVector> ns);
+
+    /// @brief Set the prolongation from p1 for p-multigrid.
+    /// @param P The prolongation onto the full owned DOF map.
+    /// @details A p-multigrid solver needs the prolongation before its
+    /// first solve, so it only applies to discretizations with p > 1.
+    void set_prolongation(Teuchos::RCP<goal::Matrix> P);
+
+    /// @brief Keep the preconditioner across solves with one matrix.
+    /// @param r Whether to reuse the preconditioner.
+    /// @details With reuse on, the preconditioner is rebuilt only after
+    /// \ref ml::LinearSolver::reset_preconditioner or when solving with
+    /// a different matrix object. The goal::solve_linear_system path
+    /// builds its own preconditioner and is unaffected.
+    void set_preconditioner_reuse(bool r) { reuse = r; }
+
+    /// @brief Discard a kept preconditioner and node-blocked operator.
+    /// @details Call this after the values of the matrix change.
+    void reset_preconditioner() { prec = Teuchos::null; op = Teuchos::null; }
+
+    /// @brief Discard the recycled Krylov subspace.
+    void reset_recycling() { recycler = Teuchos::null; }
+
+    /// @brief Returns the cumulative Belos Krylov iteration count.
+    /// @details Solves deferred to goal::solve_linear_system are not
+    /// counted.
+    long get_num_iters() { return num_iters; }
+
+    /// @brief Print the memory use after each preconditioner setup.
+    /// @param t Whether to print the memory use.
+    void set_memory_tracking(bool t) { track_memory = t; }
+
+    /// @brief Solve the linear system \f$ A x = b \f$.
+    /// @param A The owned matrix.
+    /// @param x The owned solution vector, used as the initial guess.
+    /// @param b The owned right hand side vector.
+    /// @param i The indexer, used by the default path if non-null.
+    void solve(
+        Teuchos::RCP<goal::Matrix> A,
+        Teuchos::RCP<goal::Vector> x,
+        Teuchos::RCP<goal::Vector> b,
+        goal::Indexer* i = 0);
+
+  private:
+
+    using Krylov = Belos::SolverManager<goal::ST, MultiVector, Operator>;
+
+    Teuchos::RCP<Krylov> get_krylov_solver(Teuchos::RCP<const Map> m);
+    Teuchos::RCP<MultiVector> get_null_space(Teuchos::RCP<const Map> m);
+    Teuchos::RCP<goal::Matrix> get_prolongation(Teuchos::RCP<const Map> m);
+    Teuchos::RCP<Operator> get_operator(Teuchos::RCP<goal::Matrix> A);
+    Teuchos::RCP<Operator> build_preconditioner(
+        Teuchos::RCP<goal::Matrix> A);
+    void solve_krylov(
+        Teuchos::RCP<goal::Matrix> A,
+        Teuchos::RCP<goal::Vector> x,
+        Teuchos::RCP<goal::Vector> b);
+
+    ParameterList params;
+    bool verbose;
+    bool is_amg;
+    bool is_pmg;
+    bool is_single;
+    bool is_recycled;
+    bool reuse;
+    bool is_reported;
+    bool track_memory;
+    int block_size;
+    long num_iters;
+    std::string storage;
+    LinearSolver* coarse;
+    Teuchos::RCP<MultiVector> null_space;
+    Teuchos::RCP<goal::Matrix> prolongation;
+    Teuchos::RCP<goal::Vector> node_ids;
+    Teuchos::RCP<goal::Matrix> prec_matrix;
+    Teuchos::RCP<Operator> prec;
+    Teuchos::RCP<goal::Matrix> op_matrix;
+    Teuchos::RCP<Operator> op;
+    Teuchos::RCP<Krylov> recycler;
+    Teuchos::RCP<const Map> recycle_map;
+};
+
+/// @brief Create a linear solver.
+/// @param p The linear algebra parameter list.
+LinearSolver* create_linear_solver(ParameterList const& p);
+
+/// @brief Destroy a linear solver.
+/// @param s The \ref ml::LinearSolver object to destroy.
+void destroy_linear_solver(LinearSolver* s);
+
+} // end namespace ml
+
+#endif
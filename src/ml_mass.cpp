@@ -0,0 +1,124 @@
+#include <cmath>
+#include <limits>
+#include <apf.h>
+#include <apfMesh.h>
+#include <goal_control.hpp>
+#include <goal_discretization.hpp>
+#include <goal_field.hpp>
+#include <goal_indexer.hpp>
+#include <goal_sol_info.hpp>
+#include <PCU.h>
+
+#include "ml_mass.hpp"
+#include "ml_mechanics.hpp"
+
+namespace ml {
+
+static double get_density(ParameterList const& mp) {
+  GOAL_ALWAYS_ASSERT(mp.isType<double>("rho"));
+  auto rho = mp.get<double>("rho");
+  GOAL_ALWAYS_ASSERT(rho > 0.0);
+  return rho;
+}
+
+static double get_wave_speed(ParameterList const& mp) {
+  auto E = mp.get<double>("E");
+  auto nu = mp.get<double>("nu");
+  auto rho = get_density(mp);
+  return std::sqrt(E * (1.0 - nu) / ((1.0 + nu) * (1.0 - 2.0 * nu) * rho));
+}
+
+static void get_elem_mass(
+    apf::MeshElement* me,
+    apf::Field* f,
+    double rho,
+    int q_degree,
+    std::vector<double>& mass) {
+  apf::Vector3 xi;
+  apf::NewArray<double> N;
+  auto e = apf::createElement(f, me);
+  int num_nodes = apf::countNodes(e);
+  mass.assign(num_nodes, 0.0);
+  double total = 0.0;
+  double diag = 0.0;
+  for (int ip = 0; ip < apf::countIntPoints(me, q_degree); ++ip) {
+    apf::getIntPoint(me, q_degree, ip, xi);
+    double w = apf::getIntWeight(me, q_degree, ip);
+    double dv = apf::getDV(me, xi);
+    apf::getShapeValues(e, xi, N);
+    total += rho * w * dv;
+    for (int n = 0; n < num_nodes; ++n)
+      mass[n] += rho * N[n] * N[n] * w * dv;
+  }
+  for (int n = 0; n < num_nodes; ++n)
+    diag += mass[n];
+  for (int n = 0; n < num_nodes; ++n)
+    mass[n] *= total / diag;
+  apf::destroyElement(e);
+}
+
+Teuchos::RCP<goal::Vector> compute_lumped_mass(
+    Mechanics* m,
+    goal::SolInfo* info,
+    goal::Discretization* d) {
+  auto t0 = PCU_Time();
+  auto u = m->get_u();
+  auto indexer = m->get_indexer();
+  auto mesh = d->get_apf_mesh();
+  auto f = u[0]->get_apf_field();
+  auto q_degree = 2 * m->get_p_order();
+  auto ghost_map = info->ghost->R->getMap();
+  auto owned_map = info->owned->R->getMap();
+  auto ghost = Teuchos::rcp(new goal::Vector(ghost_map));
+  auto owned = Teuchos::rcp(new goal::Vector(owned_map));
+  auto g = ghost->getDataNonConst();
+  std::vector<double> mass;
+  for (int es = 0; es < d->get_num_elem_sets(); ++es) {
+    auto rho = get_density(m->get_material_params(es));
+    for (int ws = 0; ws < d->get_num_elem_worksets(es); ++ws) {
+      auto const& elems = d->get_elems(es, ws);
+      for (size_t i = 0; i < elems.size(); ++i) {
+        auto me = apf::createMeshElement(mesh, elems[i]);
+        get_elem_mass(me, f, rho, q_degree, mass);
+        for (size_t n = 0; n < mass.size(); ++n)
+        for (size_t c = 0; c < u.size(); ++c)
+          g[indexer->get_ghost_lid(c, elems[i], n)] += mass[n];
+        apf::destroyMeshElement(me);
+      }
+    }
+  }
+  goal::Export exporter(ghost_map, owned_map);
+  owned->doExport(*ghost, exporter, Tpetra::ADD);
+  auto t1 = PCU_Time();
+  goal::print(" > lumped mass computed in %f seconds", t1 - t0);
+  return owned;
+}
+
+static double get_min_edge_length(apf::Mesh* mesh, apf::MeshEntity* elem) {
+  apf::Downward edges;
+  int num_edges = mesh->getDownward(elem, 1, edges);
+  double h = apf::measure(mesh, edges[0]);
+  for (int i = 1; i < num_edges; ++i)
+    h = std::min(h, apf::measure(mesh, edges[i]));
+  return h;
+}
+
+double compute_critical_time_step(Mechanics* m, goal::Discretization* d) {
+  auto mesh = d->get_apf_mesh();
+  double p = m->get_p_order();
+  double dt = std::numeric_limits<double>::max();
+  for (int es = 0; es < d->get_num_elem_sets(); ++es) {
+    auto c = get_wave_speed(m->get_material_params(es));
+    for (int ws = 0; ws < d->get_num_elem_worksets(es); ++ws) {
+      auto const& elems = d->get_elems(es, ws);
+      for (size_t i = 0; i < elems.size(); ++i) {
+        auto h = get_min_edge_length(mesh, elems[i]);
+        dt = std::min(dt, h / (c * p * p));
+      }
+    }
+  }
+  PCU_Min_Doubles(&dt, 1);
+  return dt;
+}
+
+} // end namespace ml
@@ -0,0 +1,45 @@
+#ifndef ml_mass_hpp
+#define ml_mass_hpp
+
+/// @file ml_mass.hpp
+
+#include <goal_data_types.hpp>
+
+/// @cond
+namespace goal {
+class Discretization;
+class SolInfo;
+}
+/// @endcond
+
+namespace ml {
+
+/// @cond
+class Mechanics;
+/// @endcond
+
+/// @brief Compute the lumped mass of the displacement DOFs.
+/// @param m The mechanics object whose indexer numbers the DOFs.
+/// @param i The solution information built on the primal indexer.
+/// @param d The relevant discretization object.
+/// @returns The owned diagonal of the lumped mass matrix.
+/// @details The density is the `rho` parameter of each element set.
+/// The element mass is lumped by HRZ diagonal scaling,
+/// \f$ M_{ii} = m_e \int \rho N_i^2 / \sum_j \int \rho N_j^2 \f$,
+/// which keeps every entry positive for high order simplices.
+Teuchos::RCP<goal::Vector> compute_lumped_mass(
+    Mechanics* m,
+    goal::SolInfo* i,
+    goal::Discretization* d);
+
+/// @brief Estimate the critical time step for explicit integration.
+/// @param m The relevant mechanics object.
+/// @param d The relevant discretization object.
+/// @details This is the minimum over all elements of
+/// \f$ h_{min} / (c p^2) \f$, where \f$ h_{min} \f$ is the shortest
+/// element edge and \f$ c \f$ the dilatational wave speed.
+double compute_critical_time_step(Mechanics* m, goal::Discretization* d);
+
+} // end namespace ml
+
+#endif
@@ -1,8 +1,15 @@
+#include <apf.h>
+#include <apfMesh.h>
 #include <goal_control.hpp>
 #include <goal_discretization.hpp>
 #include <goal_field.hpp>
 #include <goal_states.hpp>
+#include <MiniTensor.h>
+#include <PCU.h>
+#include "ml_basis_cache.hpp"
 #include "ml_mechanics.hpp"
+#include "ml_qoi.hpp"
+#include "ml_stress_output.hpp"
 
 namespace ml {
 
@@ -11,8 +18,13 @@ static ParameterList get_valid_params(goal::Discretization* d) {
   p.set<int>("p order", 0);
   p.set<int>("q degree", 0);
   p.set<std::string>("model", "");
+  p.set<bool>("write graphs", false);
+  p.set<std::string>("stress output", "");
+  p.set<std::string>("formulation", "");
+  p.set<double>("basis cache", 0.0);
   p.sublist("dirichlet bcs");
   p.sublist("traction bcs");
+  p.sublist("qoi");
   for (int i = 0; i < d->get_num_elem_sets(); ++i)
     p.sublist(d->get_elem_set_name(i));
   return p;
@@ -35,17 +47,37 @@ Mechanics::Mechanics(ParameterList const& p, goal::Discretization* d)
       is_primal(false),
       is_dual(false),
       is_error(false),
-      states(0) {
+      states(0),
+      num_state_values(0),
+      qoi(0),
+      error(0),
+      stress(0),
+      basis_cache(0) {
   validate_params(p, d);
   p_order = params.get<int>("p order");
   q_degree = params.get<int>("q degree");
   model = params.get<std::string>("model");
+  write_graphs = params.get<bool>("write graphs", false);
+  auto formulation = params.get<std::string>("formulation", "displacement");
+  if (formulation == "mixed") is_mixed = true;
+  else if (formulation == "displacement") is_mixed = false;
+  else goal::fail("unknown formulation %s", formulation.c_str());
+  if (is_mixed && (p_order < 2))
+    goal::fail("the mixed formulation needs p order > 1");
+  auto cache_mb = params.get<double>("basis cache", 0.0);
+  if (cache_mb > 0.0)
+    basis_cache = create_basis_cache(size_t(cache_mb * 1024.0 * 1024.0));
   build_fields();
+  build_qoi();
   build_states();
   build_tractions();
+  build_stress_output();
 }
 
 Mechanics::~Mechanics() {
+  if (qoi) destroy_qoi(qoi);
+  if (error) apf::destroyField(error);
+  if (stress) destroy_stress_output(stress);
   goal::destroy_states(states);
   for (size_t i = 0; i < u.size(); ++i)
     goal::destroy_field(u[i]);
@@ -57,12 +89,80 @@ Mechanics::~Mechanics() {
     goal::destroy_field(u_fine[i]);
   for (size_t i = 0; i < z_fine.size(); ++i)
     goal::destroy_field(z_fine[i]);
+  if (basis_cache) destroy_basis_cache(basis_cache);
+}
+
+void Mechanics::pre_adapt() {
+  if (basis_cache) basis_cache->clear();
+  goal::destroy_states(states);
+  states = 0;
+  if (stress) stress->destroy_fields();
+  if (! error) return;
+  apf::destroyField(error);
+  error = 0;
+}
+
+void Mechanics::post_adapt() {
+  build_states();
+  if (qoi) build_error_field();
 }
 
 ParameterList const& Mechanics::get_dbc_params() {
   return params.sublist("dirichlet bcs");
 }
 
+ParameterList const& Mechanics::get_material_params(int es_idx) {
+  return params.sublist(disc->get_elem_set_name(es_idx));
+}
+
+void Mechanics::set_material_params(
+    std::string const& es_name, ParameterList const& p) {
+  GOAL_ALWAYS_ASSERT(params.isSublist(es_name));
+  params.sublist(es_name).setParameters(p);
+}
+
+bool Mechanics::is_yielding() {
+  if (! has_history()) return false;
+  double eqps;
+  double eqps_old;
+  long num_yielding = 0;
+  auto mesh = disc->get_apf_mesh();
+  apf::MeshEntity* elem;
+  auto it = mesh->begin(mesh->getDimension());
+  while ((elem = mesh->iterate(it))) {
+    auto me = apf::createMeshElement(mesh, elem);
+    for (int ip = 0; ip < apf::countIntPoints(me, q_degree); ++ip) {
+      states->get_scalar("eqps", elem, ip, eqps);
+      states->get_scalar("eqps_old", elem, ip, eqps_old);
+      if (eqps > eqps_old) ++num_yielding;
+    }
+    apf::destroyMeshElement(me);
+  }
+  mesh->end(it);
+  PCU_Add_Longs(&num_yielding, 1);
+  return num_yielding > 0;
+}
+
+void Mechanics::update_history() {
+  if (! has_history()) return;
+  double eqps;
+  minitensor::Tensor<double> Fp(disc->get_num_dims());
+  auto mesh = disc->get_apf_mesh();
+  apf::MeshEntity* elem;
+  auto it = mesh->begin(mesh->getDimension());
+  while ((elem = mesh->iterate(it))) {
+    auto me = apf::createMeshElement(mesh, elem);
+    for (int ip = 0; ip < apf::countIntPoints(me, q_degree); ++ip) {
+      states->get_scalar("eqps", elem, ip, eqps);
+      states->get_tensor("Fp", elem, ip, Fp);
+      states->set_scalar("eqps_old", elem, ip, eqps);
+      states->set_tensor("Fp_old", elem, ip, Fp);
+    }
+    apf::destroyMeshElement(me);
+  }
+  mesh->end(it);
+}
+
 void Mechanics::set_primal() {
   is_primal = true;
   is_dual = false;
@@ -89,22 +189,37 @@ void Mechanics::build_fields() {
   if (d > 0) u.push_back(goal::create_field({disc, "ux", p, q, t}));
   if (d > 1) u.push_back(goal::create_field({disc, "uy", p, q, t}));
   if (d > 2) u.push_back(goal::create_field({disc, "uz", p, q, t}));
-  for (size_t i = 0; i < u.size(); ++i)
+  if (d > 0) z.push_back(goal::create_field({disc, "zx", p, q, t}));
+  if (d > 1) z.push_back(goal::create_field({disc, "zy", p, q, t}));
+  if (d > 2) z.push_back(goal::create_field({disc, "zz", p, q, t}));
+  for (size_t i = 0; i < u.size(); ++i) {
     u[i]->set_associated_dof_idx(i);
+    z[i]->set_associated_dof_idx(i);
+  }
+}
+
+void Mechanics::add_state(
+    const char* name, int rank, bool save_old, bool identity) {
+  int size = 1;
+  for (int i = 0; i < rank; ++i)
+    size *= disc->get_num_dims();
+  num_state_values += save_old ? 2 * size : size;
+  states->add(name, rank, save_old, identity);
 }
 
 void Mechanics::build_states() {
   small_strain = false;
+  num_state_values = 0;
   states = goal::create_states(disc, q_degree);
   if (model == "elastic") {
-    states->add("cauchy", 2);
     small_strain = true;
   } else if (model == "J2") {
-    states->add("eqps", 0, true);
-    states->add("Fp", 2, true, true);
-    states->add("cauchy", 2);
+    add_state("eqps", 0, true);
+    add_state("Fp", 2, true, true);
   } else
     goal::fail("unkown material model %s", model.c_str());
+  if (qoi)
+    add_state("grad_dz", 2);
 }
 
 void Mechanics::build_tractions() {
@@ -122,8 +237,33 @@ void Mechanics::build_tractions() {
   }
 }
 
+void Mechanics::build_qoi() {
+  if (! params.isSublist("qoi")) return;
+  qoi = create_qoi(params.sublist("qoi"), disc);
+  build_error_field();
+}
+
+void Mechanics::build_stress_output() {
+  auto type = params.get<std::string>("stress output", "element");
+  if (type == "none") return;
+  else if (type == "element")
+    stress = create_stress_output(disc, q_degree, false);
+  else if (type == "nodal")
+    stress = create_stress_output(disc, q_degree, true);
+  else
+    goal::fail("unknown stress output %s", type.c_str());
+}
+
+void Mechanics::build_error_field() {
+  auto mesh = disc->get_apf_mesh();
+  auto shape = apf::getConstant(mesh->getDimension());
+  error = apf::createField(mesh, "error", apf::SCALAR, shape);
+  apf::zeroField(error);
+}
+
 template <typename T>
-static void write_graph(goal::FieldManager fm, const char* n) {
+void Mechanics::write_graph(FieldManager fm, const char* n) {
+  if (! write_graphs) return;
   fm->writeGraphvizFile<T>(n, true, true);
 }
 
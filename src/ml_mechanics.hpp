@@ -7,7 +7,12 @@
 #include <Teuchos_ParameterList.hpp>
 
 /// @cond
+namespace apf {
+class Field;
+}
+
 namespace goal {
+class Field;
 class States;
 class Discretization;
 }
@@ -17,6 +22,12 @@ namespace ml {
 
 using Teuchos::ParameterList;
 
+/// @cond
+class QoI;
+class StressOutput;
+class BasisCache;
+/// @endcond
+
 /// @brief The mechanics physics class.
 /// @details This class is responsible for defining the primal, dual,
 /// and error models for a total Lagrangian description of the balance
@@ -37,6 +48,65 @@ class Mechanics : public goal::Physics {
     /// @brief Returns the Dirichlet bc parameters.
     ParameterList const& get_dbc_params();
 
+    /// @brief Returns the material parameters of an element set.
+    /// @param es_idx The index of the element set.
+    ParameterList const& get_material_params(int es_idx);
+
+    /// @brief Override the material parameters of an element set.
+    /// @param es_name The name of the element set.
+    /// @param p The material parameters to override.
+    /// @details The new values take effect when the model is rebuilt.
+    void set_material_params(
+        std::string const& es_name, ParameterList const& p);
+
+    /// @brief Returns the quantity of interest.
+    /// @details This is null if no qoi was specified.
+    QoI* get_qoi() { return qoi; }
+
+    /// @brief Returns the stress output fields.
+    /// @details This is null if no stress output was requested.
+    StressOutput* get_stress_output() { return stress; }
+
+    /// @brief Returns the state fields structure.
+    goal::States* get_states() { return states; }
+
+    /// @brief Returns the element-wise error indicator field.
+    /// @details This is null if no qoi was specified.
+    apf::Field* get_error_field() { return error; }
+
+    /// @brief Returns true if the model carries history states.
+    bool has_history() { return model == "J2"; }
+
+    /// @brief Returns true if any integration point is yielding.
+    /// @details A point yields if its equivalent plastic strain grew
+    /// from the old state. This is always false without history.
+    bool is_yielding();
+
+    /// @brief Accept the current history states as the old states.
+    /// @details This is called at the end of each converged time step.
+    void update_history();
+
+    /// @brief Prepare for a mesh adaptation.
+    /// @details This destroys the states and the error field, which
+    /// cannot be transferred by mesh adaptation, and clears the basis
+    /// cache.
+    void pre_adapt();
+
+    /// @brief Rebuild the mechanics data after a mesh adaptation.
+    /// @details This rebuilds the states and the error field on the
+    /// adapted mesh. History states are initialized to their defaults.
+    void post_adapt();
+
+    /// @brief Returns the polynomial order of the displacement fields.
+    int get_p_order() { return p_order; }
+
+    /// @brief Returns the integration degree.
+    int get_q_degree() { return q_degree; }
+
+    /// @brief Returns the number of state values per integration point.
+    /// @details This counts the old copies of the history states.
+    int get_num_state_values() { return num_state_values; }
+
   public:
 
     /// @brief FieldManager type.
@@ -56,7 +126,12 @@ class Mechanics : public goal::Physics {
 
     void build_fields();
     void build_states();
+    void add_state(
+        const char* name, int rank, bool save_old, bool identity = false);
     void build_tractions();
+    void build_qoi();
+    void build_error_field();
+    void build_stress_output();
 
     void build_primal_volumetric(FieldManager fm);
     void build_primal_neumann(FieldManager fm);
@@ -67,6 +142,9 @@ class Mechanics : public goal::Physics {
     void build_error_volumetric(FieldManager fm);
     void build_error_neumann(FieldManager fm);
 
+    template <typename T>
+    void write_graph(FieldManager fm, const char* n);
+
     template <typename EvalT>
     void register_volumetric(FieldManager fm);
 
@@ -82,9 +160,16 @@ class Mechanics : public goal::Physics {
     int p_order;
     int q_degree;
     bool small_strain;
+    bool write_graphs;
+    bool is_mixed;
 
     std::string model;
     goal::States* states;
+    int num_state_values;
+    QoI* qoi;
+    apf::Field* error;
+    StressOutput* stress;
+    BasisCache* basis_cache;
 
     std::map<int, Teuchos::Array<std::string> > traction_map;
 };
@@ -0,0 +1,73 @@
+#include <fstream>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <apf.h>
+#include <apfMesh.h>
+#include <goal_control.hpp>
+#include <goal_discretization.hpp>
+#include <PCU.h>
+
+#include "ml_mechanics.hpp"
+#include "ml_memory.hpp"
+
+namespace ml {
+
+static const double MB = 1024.0 * 1024.0;
+
+static long get_current_rss() {
+  long pages = 0;
+  long resident = 0;
+  std::ifstream statm("/proc/self/statm");
+  if (! (statm >> pages >> resident)) return 0;
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+static long get_peak_rss() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  return usage.ru_maxrss * 1024L;
+}
+
+void print_memory(std::string const& phase) {
+  long max[2] = {get_current_rss(), get_peak_rss()};
+  long sum[2] = {max[0], max[1]};
+  PCU_Max_Longs(max, 2);
+  PCU_Add_Longs(sum, 2);
+  goal::print(" > memory after %s:", phase.c_str());
+  goal::print("   > rss: %.1f MB max, %.1f MB total",
+      max[0] / MB, sum[0] / MB);
+  goal::print("   > peak rss: %.1f MB max, %.1f MB total",
+      max[1] / MB, sum[1] / MB);
+}
+
+void print_states_memory(Mechanics* m, goal::Discretization* d) {
+  long num_ips = 0;
+  apf::MeshEntity* elem;
+  auto mesh = d->get_apf_mesh();
+  auto it = mesh->begin(mesh->getDimension());
+  while ((elem = mesh->iterate(it))) {
+    auto me = apf::createMeshElement(mesh, elem);
+    num_ips += apf::countIntPoints(me, m->get_q_degree());
+    apf::destroyMeshElement(me);
+  }
+  mesh->end(it);
+  long ip_bytes = m->get_num_state_values() * sizeof(double);
+  long bytes = num_ips * ip_bytes;
+  PCU_Add_Longs(&bytes, 1);
+  goal::print(" > states: %ld bytes per ip, %.1f MB total",
+      ip_bytes, bytes / MB);
+}
+
+void print_matrix_memory(
+    std::string const& name, Teuchos::RCP<goal::Matrix> A) {
+  long values[2];
+  long rows = A->getNodeNumRows();
+  values[0] = A->getNodeNumEntries();
+  values[1] = values[0] * (sizeof(goal::ST) + sizeof(goal::LO));
+  values[1] += (rows + 1) * sizeof(size_t);
+  PCU_Add_Longs(values, 2);
+  goal::print(" > %s: %ld nonzeros, %.1f MB",
+      name.c_str(), values[0], values[1] / MB);
+}
+
+} // end namespace ml
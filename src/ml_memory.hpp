@@ -0,0 +1,43 @@
+#ifndef ml_memory_hpp
+#define ml_memory_hpp
+
+/// @file ml_memory.hpp
+
+#include <string>
+#include <goal_data_types.hpp>
+
+/// @cond
+namespace goal {
+class Discretization;
+}
+/// @endcond
+
+namespace ml {
+
+/// @cond
+class Mechanics;
+/// @endcond
+
+/// @brief Print the memory use of all ranks after a solver phase.
+/// @param phase The name of the phase that just completed.
+/// @details The current and the peak resident set sizes are reduced
+/// to their maximum and their sum over the ranks. The peak is the high
+/// water mark of the whole run so far.
+void print_memory(std::string const& phase);
+
+/// @brief Print the memory of the history states.
+/// @param m The mechanics object owning the states.
+/// @param d The relevant discretization object.
+void print_states_memory(Mechanics* m, goal::Discretization* d);
+
+/// @brief Print the memory of a matrix.
+/// @param name The name of the matrix.
+/// @param A The matrix.
+/// @details The nonzeros and the bytes of the values, column indices
+/// and row offsets are summed over the ranks.
+void print_matrix_memory(
+    std::string const& name, Teuchos::RCP<goal::Matrix> A);
+
+} // end namespace ml
+
+#endif
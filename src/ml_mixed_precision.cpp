@@ -0,0 +1,57 @@
+#include <goal_control.hpp>
+#include <MueLu_CreateTpetraPreconditioner.hpp>
+
+#include "ml_mixed_precision.hpp"
+
+namespace ml {
+
+SinglePrecisionAMG::SinglePrecisionAMG(
+    ParameterList const& p,
+    Teuchos::RCP<goal::Matrix> A_in,
+    Teuchos::RCP<MultiVector> ns)
+    : A(A_in) {
+
+  // round the operator and the near null space to single precision.
+  // the hierarchy holds the only reference to the copy.
+  Teuchos::RCP<FloatOperator> A_float = A->convert<float>();
+  Teuchos::RCP<FloatMultiVector> ns_float;
+  if (Teuchos::nonnull(ns)) {
+    ns_float = Teuchos::rcp(
+        new FloatMultiVector(ns->getMap(), ns->getNumVectors()));
+    Tpetra::deep_copy(*ns_float, *ns);
+  }
+
+  // build the hierarchy
+  auto mp = p;
+  M = MueLu::CreateTpetraPreconditioner(A_float, mp, Teuchos::null, ns_float);
+}
+
+Teuchos::RCP<const Map> SinglePrecisionAMG::getDomainMap() const {
+  return A->getDomainMap();
+}
+
+Teuchos::RCP<const Map> SinglePrecisionAMG::getRangeMap() const {
+  return A->getRangeMap();
+}
+
+void SinglePrecisionAMG::apply(
+    MultiVector const& X,
+    MultiVector& Y,
+    Teuchos::ETransp mode,
+    goal::ST alpha,
+    goal::ST beta) const {
+  GOAL_DEBUG_ASSERT(mode == Teuchos::NO_TRANS);
+  (void)mode;
+  auto n = X.getNumVectors();
+  if (Z.is_null() || Z->getNumVectors() != n) {
+    X_float = Teuchos::rcp(new FloatMultiVector(X.getMap(), n));
+    Y_float = Teuchos::rcp(new FloatMultiVector(Y.getMap(), n));
+    Z = Teuchos::rcp(new MultiVector(Y.getMap(), n));
+  }
+  Tpetra::deep_copy(*X_float, X);
+  M->apply(*X_float, *Y_float);
+  Tpetra::deep_copy(*Z, *Y_float);
+  Y.update(alpha, *Z, beta);
+}
+
+} // end namespace ml
@@ -0,0 +1,78 @@
+#ifndef ml_mixed_precision_hpp
+#define ml_mixed_precision_hpp
+
+/// @file ml_mixed_precision.hpp
+
+#include <Teuchos_ParameterList.hpp>
+#include <Tpetra_CrsMatrix.hpp>
+#include "ml_linear_algebra.hpp"
+
+namespace ml {
+
+using Teuchos::ParameterList;
+
+/// @brief An AMG preconditioner built and applied in single precision.
+/// @details The assembled double precision Jacobian is converted to a
+/// single precision copy, from which the MueLu hierarchy is built.
+/// The coarse operators, transfer operators and smoothers of the
+/// hierarchy are stored in single precision, which halves their memory
+/// and the bandwidth of each V-cycle. The finest level is the single
+/// precision copy, which the hierarchy keeps in addition to the double
+/// precision Jacobian needed by the outer Krylov method. The total
+/// memory is therefore only lower than with the double precision
+/// hierarchy, whose finest level is the Jacobian itself, when the
+/// coarse levels and smoothers outweigh half of the Jacobian.
+///
+/// Each application rounds the input to single precision, applies the
+/// hierarchy and converts the result back. The outer Krylov method
+/// runs in double precision and corrects for the rounding, so the
+/// converged solution keeps double precision accuracy. This needs
+/// Tpetra and MueLu built with float instantiations, which the build
+/// checks for.
+class SinglePrecisionAMG : public Operator {
+
+  public:
+
+    /// @brief Build the single precision hierarchy.
+    /// @param p The MueLu parameter list.
+    /// @param A The double precision operator.
+    /// @param ns The near null space, or null.
+    SinglePrecisionAMG(
+        ParameterList const& p,
+        Teuchos::RCP<goal::Matrix> A,
+        Teuchos::RCP<MultiVector> ns);
+
+    /// @brief Returns the domain map of the operator.
+    Teuchos::RCP<const Map> getDomainMap() const;
+
+    /// @brief Returns the range map of the operator.
+    Teuchos::RCP<const Map> getRangeMap() const;
+
+    /// @brief Apply the hierarchy: \f$ Y = \beta Y + \alpha M^{-1} X \f$.
+    void apply(
+        MultiVector const& X,
+        MultiVector& Y,
+        Teuchos::ETransp mode = Teuchos::NO_TRANS,
+        goal::ST alpha = Teuchos::ScalarTraits<goal::ST>::one(),
+        goal::ST beta = Teuchos::ScalarTraits<goal::ST>::zero()) const;
+
+  private:
+
+    using FloatMatrix =
+      Tpetra::CrsMatrix<float, goal::LO, goal::GO, goal::KNode>;
+    using FloatMultiVector =
+      Tpetra::MultiVector<float, goal::LO, goal::GO, goal::KNode>;
+    using FloatOperator =
+      Tpetra::Operator<float, goal::LO, goal::GO, goal::KNode>;
+
+    Teuchos::RCP<goal::Matrix> A;
+    Teuchos::RCP<FloatOperator> M;
+
+    mutable Teuchos::RCP<FloatMultiVector> X_float;
+    mutable Teuchos::RCP<FloatMultiVector> Y_float;
+    mutable Teuchos::RCP<MultiVector> Z;
+};
+
+} // end namespace ml
+
+#endif
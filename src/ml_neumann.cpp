@@ -1,8 +1,14 @@
+#include <type_traits>
 #include <goal_discretization.hpp>
 #include <goal_ev_basis.hpp>
 
 #include "ml_mechanics.hpp"
+#include "ml_ev_cached_basis.hpp"
 #include "ml_ev_traction.hpp"
+#include "ml_ev_traction_error.hpp"
+#include "ml_ev_avg_disp.hpp"
+#include "ml_qoi.hpp"
+#include "ml_error.hpp"
 
 using Teuchos::rcp;
 using goal::Traits;
@@ -23,19 +29,42 @@ void ml::Mechanics::register_neumann(goal::FieldManager fm) {
   }
 
   // set the displacement field basis functions
-  if (is_primal || is_dual) {
+  if (basis_cache) {
+    auto ev = rcp(new ml::CachedBasis<EvalT, Traits>(
+          disp[0], basis_cache, -1 - side_set, type));
+    fm->registerEvaluator<EvalT>(ev);
+  } else {
     auto ev = rcp(new goal::Basis<EvalT, Traits>(disp[0], type));
     fm->registerEvaluator<EvalT>(ev);
   }
 
   // compute tractions if needed for this side set
-  if (traction_map.count(side_set)) {
+  if ((is_primal || is_dual) && traction_map.count(side_set)) {
     auto bc = traction_map[side_set];
     auto ev = rcp(new ml::Traction<EvalT, Traits>(disp, bc, indexer, type));
     fm->registerEvaluator<EvalT>(ev);
     fm->requireField<EvalT>(*ev->evaluatedFields()[0]);
   }
 
+  // compute the traction part of the dual weighted residual
+  if (is_error && traction_map.count(side_set)) {
+    auto bc = traction_map[side_set];
+    auto tag = ml::find_side_weights(disc);
+    auto ev = rcp(new ml::TractionError<EvalT, Traits>(
+          disp, bc, tag, error, type));
+    fm->registerEvaluator<EvalT>(ev);
+    fm->requireField<EvalT>(*ev->evaluatedFields()[0]);
+  }
+
+  // accumulate the quantity of interest for the dual problem
+  bool is_residual = std::is_same<EvalT, Residual>::value;
+  bool is_qoi_set = qoi && (qoi->get_side_set_idx() == side_set);
+  if (is_primal && is_residual && is_qoi_set) {
+    auto ev = rcp(new ml::AvgDisp<EvalT, Traits>(disp, qoi, indexer, type));
+    fm->registerEvaluator<EvalT>(ev);
+    fm->requireField<EvalT>(*ev->evaluatedFields()[0]);
+  }
+
   // set the FAD data and finalize the PHX field maanger registration.
   goal::set_extended_data_type_dims(indexer, fm, type);
   fm->postRegistrationSetupForType<EvalT>(NULL);
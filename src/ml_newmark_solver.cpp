@@ -0,0 +1,198 @@
+#include <cmath>
+#include <apf.h>
+#include <goal_control.hpp>
+#include <goal_dbcs.hpp>
+#include <goal_sol_info.hpp>
+#include <PCU.h>
+
+#include "ml_balance.hpp"
+#include "ml_checkpoint.hpp"
+#include "ml_linear_algebra.hpp"
+#include "ml_linear_solver.hpp"
+#include "ml_mass.hpp"
+#include "ml_mechanics.hpp"
+#include "ml_newmark_solver.hpp"
+
+namespace ml {
+
+static ParameterList get_valid_newmark_params() {
+  ParameterList p;
+  p.set<double>("time step", 0.0);
+  p.set<double>("final time", 0.0);
+  p.set<double>("beta", 0.0);
+  p.set<double>("gamma", 0.0);
+  p.set<double>("mass damping", 0.0);
+  p.set<double>("contraction", 0.0);
+  p.set<int>("output interval", 0);
+  p.set<bool>("reuse tangent", true);
+  p.sublist("rebalance");
+  return p;
+}
+
+NewmarkSolver::NewmarkSolver(ParameterList const& p)
+    : StaticSolver(p),
+      has_dbc_mass(true) {
+  GOAL_ALWAYS_ASSERT(params.isSublist("newmark"));
+  GOAL_ALWAYS_ASSERT(params.isType<int>("nonlinear max iters"));
+  GOAL_ALWAYS_ASSERT(params.isType<double>("nonlinear tolerance"));
+  GOAL_ALWAYS_ASSERT(! params.get<bool>("static condensation", false));
+  GOAL_ALWAYS_ASSERT(! is_adaptive);
+  GOAL_ALWAYS_ASSERT(! params.isSublist("anderson"));
+  auto& np = params.sublist("newmark");
+  GOAL_ALWAYS_ASSERT(np.isType<double>("time step"));
+  GOAL_ALWAYS_ASSERT(np.isType<double>("final time"));
+  np.validateParameters(get_valid_newmark_params(), 0);
+  beta = np.get<double>("beta", 0.25);
+  gamma = np.get<double>("gamma", 0.5);
+  alpha = np.get<double>("mass damping", 0.0);
+  contraction = np.get<double>("contraction", 0.5);
+  reuse_tangent = np.get<bool>("reuse tangent", true);
+  np.get<int>("output interval", 0);
+  linear_solver->set_preconditioner_reuse(reuse_tangent);
+}
+
+void NewmarkSolver::build_dynamic_data() {
+  build_primal_data();
+  mass = ml::compute_lumped_mass(mech, info, disc);
+  has_dbc_mass = true;
+  auto map = mass->getMap();
+  delta = Teuchos::rcp(new goal::Vector(map));
+  a_old = Teuchos::rcp(new goal::Vector(map));
+  v_old = Teuchos::rcp(new goal::Vector(map));
+  a = Teuchos::rcp(new goal::Vector(map));
+  v = Teuchos::rcp(new goal::Vector(map));
+  inertia = Teuchos::rcp(new goal::Vector(map));
+}
+
+void NewmarkSolver::assemble_primal(
+    double t, double dt, bool with_tangent) {
+
+  // newmark kinematics of the current iterate
+  double c0 = 1.0 / (beta * dt * dt);
+  a->update(c0, *delta, -1.0 / (beta * dt), *v_old, 0.0);
+  a->update(1.0 - 0.5 / beta, *a_old, 1.0);
+  v->update(1.0, *v_old, dt * (1.0 - gamma), *a_old, 0.0);
+  v->update(dt * gamma, *a, 1.0);
+
+  // assemble the static contributions
+  StaticSolver::assemble_primal(t, dt, with_tangent);
+  if (with_tangent) {
+    if (has_dbc_mass) {
+      // dirichlet rows carry no inertia
+      auto dbc_rows = get_dbc_rows(info->owned->dRdu);
+      auto is_dbc = dbc_rows->getData();
+      auto m = mass->getDataNonConst();
+      for (size_t i = 0; i < mass->getLocalLength(); ++i)
+        if (is_dbc[i] != 0.0) m[i] = 0.0;
+      has_dbc_mass = false;
+    }
+    double c = c0 * (1.0 + alpha * gamma * dt);
+    ml::add_to_diagonal(info->owned->dRdu, mass, c);
+  }
+
+  // add the inertia and damping forces
+  inertia->update(1.0, *a, alpha, *v, 0.0);
+  info->owned->R->elementWiseMultiply(1.0, *mass, *inertia, 1.0);
+}
+
+void NewmarkSolver::add_to_primal() {
+  StaticSolver::add_to_primal();
+  delta->update(1.0, *(info->owned->du), 1.0);
+}
+
+bool NewmarkSolver::should_rebalance(int step) {
+  auto np = params.sublist("newmark");
+  if (! np.isSublist("rebalance")) return false;
+  auto rp = np.sublist("rebalance");
+  auto interval = rp.get<int>("interval", 1);
+  if ((interval < 1) || (step % interval != 0)) return false;
+  return ml::needs_rebalance(rp, mech, disc);
+}
+
+void NewmarkSolver::rebalance_mesh() {
+
+  // the kinematic history moves with the mesh in nodal fields
+  auto fa = ml::save_to_fields(mech, info, a_old, "ml_a_old");
+  auto fv = ml::save_to_fields(mech, info, v_old, "ml_v_old");
+  destroy_primal_data();
+  ml::rebalance(params.sublist("newmark").sublist("rebalance"), mech, disc);
+  build_dynamic_data();
+  a_old = ml::load_from_fields(mech, info, fa);
+  v_old = ml::load_from_fields(mech, info, fv);
+  needs_tangent = true;
+  is_mesh_changed = true;
+}
+
+void NewmarkSolver::restore_kinematics() {
+  auto num_comps = mech->get_u().size();
+  if (restart_fields.size() != 2 * num_comps)
+    goal::fail("the checkpoint holds no newmark kinematics");
+  auto mid = restart_fields.begin() + num_comps;
+  std::vector<apf::Field*> fa(restart_fields.begin(), mid);
+  std::vector<apf::Field*> fv(mid, restart_fields.end());
+  a_old = ml::load_from_fields(mech, info, fa);
+  v_old = ml::load_from_fields(mech, info, fv);
+  restart_fields.clear();
+}
+
+void NewmarkSolver::write_checkpoint(int step) {
+  auto fa = ml::save_to_fields(mech, info, a_old, "ml_a_old");
+  auto fv = ml::save_to_fields(mech, info, v_old, "ml_v_old");
+  std::vector<apf::Field*> nodal(fa);
+  nodal.insert(nodal.end(), fv.begin(), fv.end());
+  auto cp = params.sublist("checkpoint");
+  ml::write_checkpoint(cp, step, mech, disc, is_mesh_changed, nodal);
+  for (size_t i = 0; i < nodal.size(); ++i)
+    apf::destroyField(nodal[i]);
+}
+
+void NewmarkSolver::solve() {
+  goal::print("solving");
+  auto np = params.sublist("newmark");
+  auto final_time = np.get<double>("final time");
+  auto interval = np.get<int>("output interval");
+  int num_steps = std::max(1, (int)std::round(
+        final_time / np.get<double>("time step")));
+  double dt = final_time / num_steps;
+  goal::print(" > time step: %e", dt);
+  goal::print(" > num steps: %d", num_steps);
+
+  build_dynamic_data();
+  if (start_step > 0) {
+    goal::print(" > restarted after step %d of %d", start_step, num_steps);
+    restore_kinematics();
+  } else {
+    write_output(0, 0.0);
+  }
+
+  int num_iters = 0;
+  auto t0 = PCU_Time();
+  for (int step = start_step + 1; step <= num_steps; ++step) {
+    double t = step * dt;
+    goal::print("** time step %d: t = %e", step, t);
+    goal::set_dbc_values(mech, t);
+    delta->putScalar(0.0);
+    num_iters += solve_newton(t, dt);
+    a_old->update(1.0, *a, 0.0);
+    v_old->update(1.0, *v, 0.0);
+
+    // plastic flow changes the tangent for the next step
+    if (mech->is_yielding()) needs_tangent = true;
+    if (np.isSublist("rebalance")) ml::mark_yielding(mech, disc);
+    mech->update_history();
+
+    bool is_output = (step == num_steps);
+    if (interval > 0) is_output = is_output || (step % interval == 0);
+    if (is_output) write_output(step, t);
+    if (should_checkpoint(step, step == num_steps)) write_checkpoint(step);
+    if ((step < num_steps) && should_rebalance(step)) rebalance_mesh();
+  }
+  auto t1 = PCU_Time();
+  goal::print(" > newton iterations: %d", num_iters);
+  goal::print(" > tangent assemblies: %d", num_tangents);
+  if (linear_solver->get_num_iters() > 0)
+    goal::print(" > krylov iterations: %ld", linear_solver->get_num_iters());
+  goal::print(" > time integration: %f seconds", t1 - t0);
+}
+
+} // end namespace ml
@@ -0,0 +1,77 @@
+#ifndef ml_newmark_solver_hpp
+#define ml_newmark_solver_hpp
+
+/// @file ml_newmark_solver.hpp
+
+#include <goal_data_types.hpp>
+#include "ml_static_solver.hpp"
+
+namespace ml {
+
+/// @brief An implicit Newmark dynamics solver.
+/// @details This adds inertia and mass proportional damping to the
+/// Newton loop of the \ref ml::StaticSolver, which solves each time
+/// step. The effective residual is \f$ R(u) + M (a + \alpha v) \f$,
+/// with \f$ M \f$ the lumped mass of \ref ml::compute_lumped_mass and
+/// \f$ a, v \f$ given by the Newmark update, and the effective tangent
+/// adds the scaled lumped mass to the diagonal of the Jacobian. The
+/// effective tangent is kept across Newton iterations and time steps,
+/// together with an `amg` or `p-multigrid` preconditioner built from
+/// it. It is reassembled only after a step with yielding integration
+/// points, or when a frozen iteration fails to reduce the residual by
+/// the `contraction` factor.
+///
+/// The `newmark` sublist holds the `time step`, the `final time`, the
+/// Newmark `beta` (default 0.25) and `gamma` (default 0.5), the
+/// `mass damping` \f$ \alpha \f$ (default 0), the `contraction` factor
+/// (default 0.5), the `output interval` in steps (default 0: final
+/// step only) and `reuse tangent` (default true).
+///
+/// An optional `rebalance` sublist repartitions the mesh between steps
+/// when the plastic integration point cost is imbalanced, see
+/// \ref ml::needs_rebalance. Its `interval` (default 1) is the number of
+/// steps between imbalance checks.
+///
+/// An optional `checkpoint` sublist writes a checkpoint every `interval`
+/// steps and after the final step, see \ref ml::write_checkpoint. Besides
+/// the displacement and history it holds the acceleration and velocity
+/// of the step, so that `restart from` continues the time integration
+/// after the checkpointed step.
+class NewmarkSolver : public StaticSolver {
+
+  public:
+
+    /// @brief Construct the Newmark solver.
+    /// @param p The full parameter list describing this solver.
+    NewmarkSolver(ParameterList const& p);
+
+    /// @brief Run the solver.
+    void solve();
+
+  private:
+
+    void build_dynamic_data();
+    void assemble_primal(double t, double dt, bool with_tangent);
+    void add_to_primal();
+    bool should_rebalance(int step);
+    void rebalance_mesh();
+    void restore_kinematics();
+    void write_checkpoint(int step);
+
+    double beta;
+    double gamma;
+    double alpha;
+    bool has_dbc_mass;
+
+    Teuchos::RCP<goal::Vector> mass;
+    Teuchos::RCP<goal::Vector> delta;
+    Teuchos::RCP<goal::Vector> a_old;
+    Teuchos::RCP<goal::Vector> v_old;
+    Teuchos::RCP<goal::Vector> a;
+    Teuchos::RCP<goal::Vector> v;
+    Teuchos::RCP<goal::Vector> inertia;
+};
+
+} // end namespace ml
+
+#endif
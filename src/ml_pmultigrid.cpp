@@ -0,0 +1,100 @@
+#include <goal_control.hpp>
+#include <Ifpack2_Factory.hpp>
+#include <TpetraExt_MatrixMatrix.hpp>
+
+#include "ml_linear_solver.hpp"
+#include "ml_pmultigrid.hpp"
+
+namespace ml {
+
+using RowMatrix =
+  Tpetra::RowMatrix<goal::ST, goal::LO, goal::GO, goal::KNode>;
+
+static ParameterList get_smoother_params(ParameterList const& p) {
+  ParameterList sp;
+  if (p.isSublist("smoother params")) sp = p.sublist("smoother params");
+  auto type = p.get<std::string>("smoother");
+  if (type == "chebyshev") {
+    sp.get<int>("chebyshev: degree", 2);
+  } else if (type == "jacobi") {
+    sp.get<std::string>("relaxation: type", "Jacobi");
+    sp.get<double>("relaxation: damping factor", 0.6);
+    sp.get<int>("relaxation: sweeps", 2);
+  } else {
+    goal::fail("unknown p-multigrid smoother %s", type.c_str());
+  }
+  return sp;
+}
+
+PMultigrid::PMultigrid(
+    ParameterList const& p,
+    Teuchos::RCP<goal::Matrix> A_in,
+    Teuchos::RCP<goal::Matrix> P_in,
+    LinearSolver* c)
+    : A(A_in),
+      P(P_in),
+      coarse(c) {
+
+  // form the galerkin coarse operator
+  auto AP = Teuchos::rcp(new goal::Matrix(A->getRowMap(), 0));
+  Tpetra::MatrixMatrix::Multiply(*A, false, *P, false, *AP);
+  A_coarse = Teuchos::rcp(new goal::Matrix(P->getDomainMap(), 0));
+  Tpetra::MatrixMatrix::Multiply(*P, true, *AP, false, *A_coarse);
+
+  // build the fine level smoother
+  auto type = p.get<std::string>("smoother");
+  auto name = (type == "chebyshev") ? "CHEBYSHEV" : "RELAXATION";
+  Ifpack2::Factory factory;
+  smoother = factory.create<RowMatrix>(name, A);
+  smoother->setParameters(get_smoother_params(p));
+  smoother->initialize();
+  smoother->compute();
+
+  z = Teuchos::rcp(new goal::Vector(A->getDomainMap()));
+  r = Teuchos::rcp(new goal::Vector(A->getRangeMap()));
+  e = Teuchos::rcp(new goal::Vector(A->getDomainMap()));
+  r_coarse = Teuchos::rcp(new goal::Vector(P->getDomainMap()));
+  e_coarse = Teuchos::rcp(new goal::Vector(P->getDomainMap()));
+}
+
+Teuchos::RCP<const Map> PMultigrid::getDomainMap() const {
+  return A->getDomainMap();
+}
+
+Teuchos::RCP<const Map> PMultigrid::getRangeMap() const {
+  return A->getRangeMap();
+}
+
+void PMultigrid::apply(
+    MultiVector const& X,
+    MultiVector& Y,
+    Teuchos::ETransp mode,
+    goal::ST alpha,
+    goal::ST beta) const {
+  GOAL_DEBUG_ASSERT(mode == Teuchos::NO_TRANS);
+  (void)mode;
+  for (size_t j = 0; j < X.getNumVectors(); ++j) {
+    auto x = X.getVector(j);
+
+    // pre-smooth from a zero initial guess
+    smoother->apply(*x, *z);
+
+    // coarse grid correction
+    A->apply(*z, *r);
+    r->update(1.0, *x, -1.0);
+    P->apply(*r, *r_coarse, Teuchos::TRANS);
+    e_coarse->putScalar(0.0);
+    coarse->solve(A_coarse, e_coarse, r_coarse);
+    P->apply(*e_coarse, *z, Teuchos::NO_TRANS, 1.0, 1.0);
+
+    // post-smooth
+    A->apply(*z, *r);
+    r->update(1.0, *x, -1.0);
+    smoother->apply(*r, *e);
+    z->update(1.0, *e, 1.0);
+
+    Y.getVectorNonConst(j)->update(alpha, *z, beta);
+  }
+}
+
+} // end namespace ml
@@ -0,0 +1,75 @@
+#ifndef ml_pmultigrid_hpp
+#define ml_pmultigrid_hpp
+
+/// @file ml_pmultigrid.hpp
+
+#include <Ifpack2_Preconditioner.hpp>
+#include <Teuchos_ParameterList.hpp>
+#include "ml_linear_algebra.hpp"
+
+namespace ml {
+
+using Teuchos::ParameterList;
+
+/// @cond
+class LinearSolver;
+/// @endcond
+
+/// @brief A two level p-multigrid preconditioner.
+/// @details The coarse level is the p1 discretization on the same mesh.
+/// Its operator is the Galerkin product \f$ A_1 = P^T A P \f$, with
+/// \f$ P \f$ the Lagrange interpolation from p1 to the fine order, so
+/// the coarse level sees the same element sets, material parameters
+/// and history as the fine level. Each application is a V-cycle with
+/// one pre- and one post-smoothing step of an Ifpack2 Chebyshev or
+/// Jacobi smoother and a coarse solve through a \ref ml::LinearSolver.
+class PMultigrid : public Operator {
+
+  public:
+
+    /// @brief Construct the preconditioner.
+    /// @param p The p-multigrid parameter list.
+    /// @param A The fine level operator.
+    /// @param P The prolongation from the coarse level.
+    /// @param c The linear solver for the coarse level.
+    PMultigrid(
+        ParameterList const& p,
+        Teuchos::RCP<goal::Matrix> A,
+        Teuchos::RCP<goal::Matrix> P,
+        LinearSolver* c);
+
+    /// @brief Returns the domain map of the fine level operator.
+    Teuchos::RCP<const Map> getDomainMap() const;
+
+    /// @brief Returns the range map of the fine level operator.
+    Teuchos::RCP<const Map> getRangeMap() const;
+
+    /// @brief Apply one V-cycle: \f$ Y = \beta Y + \alpha M^{-1} X \f$.
+    void apply(
+        MultiVector const& X,
+        MultiVector& Y,
+        Teuchos::ETransp mode = Teuchos::NO_TRANS,
+        goal::ST alpha = Teuchos::ScalarTraits<goal::ST>::one(),
+        goal::ST beta = Teuchos::ScalarTraits<goal::ST>::zero()) const;
+
+  private:
+
+    using Smoother =
+      Ifpack2::Preconditioner<goal::ST, goal::LO, goal::GO, goal::KNode>;
+
+    Teuchos::RCP<goal::Matrix> A;
+    Teuchos::RCP<goal::Matrix> P;
+    Teuchos::RCP<goal::Matrix> A_coarse;
+    Teuchos::RCP<Smoother> smoother;
+    LinearSolver* coarse;
+
+    Teuchos::RCP<goal::Vector> z;
+    Teuchos::RCP<goal::Vector> r;
+    Teuchos::RCP<goal::Vector> e;
+    Teuchos::RCP<goal::Vector> r_coarse;
+    Teuchos::RCP<goal::Vector> e_coarse;
+};
+
+} // end namespace ml
+
+#endif
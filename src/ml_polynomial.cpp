@@ -0,0 +1,31 @@
+#include <cmath>
+#include <apfVector.h>
+
+#include "ml_polynomial.hpp"
+
+namespace ml {
+
+std::vector<Monomial> get_monomials(int dim, int degree) {
+  std::vector<Monomial> monomials;
+  for (int a = 0; a <= degree; ++a)
+  for (int b = 0; b <= ((dim > 1) ? degree - a : 0); ++b)
+  for (int c = 0; c <= ((dim > 2) ? degree - a - b : 0); ++c)
+    monomials.push_back({{a, b, c}});
+  return monomials;
+}
+
+double eval_monomial(Monomial const& m, apf::Vector3 const& x) {
+  return
+    std::pow(x[0], m[0]) *
+    std::pow(x[1], m[1]) *
+    std::pow(x[2], m[2]);
+}
+
+double eval_monomial_deriv(Monomial const& m, apf::Vector3 const& x, int d) {
+  if (m[d] == 0) return 0.0;
+  Monomial n = m;
+  n[d] -= 1;
+  return m[d] * eval_monomial(n, x);
+}
+
+} // end namespace ml
@@ -0,0 +1,33 @@
+#ifndef ml_polynomial_hpp
+#define ml_polynomial_hpp
+
+/// @file ml_polynomial.hpp
+
+#include <array>
+#include <vector>
+#include <apfVector.h>
+
+namespace ml {
+
+/// @brief The exponents of a monomial in three coordinates.
+using Monomial = std::array<int, 3>;
+
+/// @brief Get the complete set of monomials up to a given degree.
+/// @param dim The spatial dimension.
+/// @param degree The maximum total degree.
+std::vector<Monomial> get_monomials(int dim, int degree);
+
+/// @brief Evaluate a monomial at a point.
+/// @param m The monomial.
+/// @param x The (typically scaled) point.
+double eval_monomial(Monomial const& m, apf::Vector3 const& x);
+
+/// @brief Evaluate the derivative of a monomial at a point.
+/// @param m The monomial.
+/// @param x The (typically scaled) point.
+/// @param d The coordinate direction of the derivative.
+double eval_monomial_deriv(Monomial const& m, apf::Vector3 const& x, int d);
+
+} // end namespace ml
+
+#endif
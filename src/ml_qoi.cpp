@@ -0,0 +1,82 @@
+#include <goal_control.hpp>
+#include <goal_discretization.hpp>
+#include <goal_sol_info.hpp>
+#include <Teuchos_CommHelpers.hpp>
+
+#include "ml_qoi.hpp"
+
+namespace ml {
+
+static ParameterList get_valid_params() {
+  ParameterList p;
+  p.set<std::string>("type", "");
+  p.set<std::string>("side set", "");
+  p.set<std::string>("field", "");
+  return p;
+}
+
+static void validate_params(ParameterList const& p) {
+  GOAL_ALWAYS_ASSERT(p.isType<std::string>("type"));
+  GOAL_ALWAYS_ASSERT(p.isType<std::string>("side set"));
+  GOAL_ALWAYS_ASSERT(p.isType<std::string>("field"));
+  p.validateParameters(get_valid_params(), 0);
+}
+
+QoI::QoI(ParameterList const& p, goal::Discretization* d)
+    : value(0.0),
+      measure(0.0) {
+  validate_params(p);
+  auto type = p.get<std::string>("type");
+  auto ss_name = p.get<std::string>("side set");
+  auto field = p.get<std::string>("field");
+  if (type != "avg displacement")
+    goal::fail("unknown qoi type %s", type.c_str());
+  side_set = d->get_side_set_idx(ss_name);
+  if (field == "ux") component = 0;
+  else if (field == "uy") component = 1;
+  else if (field == "uz") component = 2;
+  else goal::fail("unknown qoi field %s", field.c_str());
+  GOAL_ALWAYS_ASSERT(component < d->get_num_dims());
+}
+
+void QoI::pre_evaluate(goal::SolInfo* i) {
+  auto ghost_map = i->ghost->R->getMap();
+  auto owned_map = i->owned->R->getMap();
+  if (ghost_dJdu.is_null() || ghost_dJdu->getMap() != ghost_map) {
+    ghost_dJdu = Teuchos::rcp(new goal::Vector(ghost_map));
+    owned_dJdu = Teuchos::rcp(new goal::Vector(owned_map));
+    exporter = Teuchos::rcp(new goal::Export(ghost_map, owned_map));
+  }
+  ghost_dJdu->putScalar(0.0);
+  owned_dJdu->putScalar(0.0);
+  value = 0.0;
+  measure = 0.0;
+}
+
+void QoI::add_value(double u, double wdv) {
+  value += u * wdv;
+  measure += wdv;
+}
+
+void QoI::post_evaluate() {
+  GOAL_DEBUG_ASSERT(Teuchos::nonnull(ghost_dJdu));
+  owned_dJdu->doExport(*ghost_dJdu, *exporter, Tpetra::ADD);
+  auto comm = owned_dJdu->getMap()->getComm();
+  double local[2] = {value, measure};
+  double global[2] = {0.0, 0.0};
+  Teuchos::reduceAll(*comm, Teuchos::REDUCE_SUM, 2, local, global);
+  GOAL_ALWAYS_ASSERT(global[1] > 0.0);
+  value = global[0] / global[1];
+  measure = global[1];
+  owned_dJdu->scale(1.0 / measure);
+}
+
+QoI* create_qoi(ParameterList const& p, goal::Discretization* d) {
+  return new QoI(p, d);
+}
+
+void destroy_qoi(QoI* q) {
+  delete q;
+}
+
+} // end namespace ml
@@ -0,0 +1,90 @@
+#ifndef ml_qoi_hpp
+#define ml_qoi_hpp
+
+/// @file ml_qoi.hpp
+
+#include <goal_data_types.hpp>
+#include <Teuchos_ParameterList.hpp>
+
+/// @cond
+namespace goal {
+class Discretization;
+class SolInfo;
+}
+/// @endcond
+
+namespace ml {
+
+using Teuchos::ParameterList;
+
+/// @brief A quantity of interest used to drive the dual problem.
+/// @details Currently the only supported quantity of interest is the
+/// average of a displacement component over a side set:
+/// \f$ J(u) = \frac{1}{|\Gamma|} \int_{\Gamma} u_i \, d \Gamma \f$.
+/// The value and the derivative \f$ \partial J / \partial u \f$ are
+/// accumulated by the \ref ml::AvgDisp evaluator during primal residual
+/// evaluations, so no additional assembly is required for the dual.
+class QoI {
+
+  public:
+
+    /// @brief Construct the quantity of interest.
+    /// @param p The qoi parameter list.
+    /// @param d The relevant discretization object.
+    QoI(ParameterList const& p, goal::Discretization* d);
+
+    /// @brief Returns the index of the side set the qoi is defined on.
+    int get_side_set_idx() { return side_set; }
+
+    /// @brief Returns the displacement component the qoi measures.
+    int get_component() { return component; }
+
+    /// @brief Prepare for accumulation during an assembly.
+    /// @param i The current solution information.
+    /// @details This (re)allocates the ghost and owned derivative
+    /// vectors if the linear algebra maps have changed and zeros all
+    /// accumulated quantities.
+    void pre_evaluate(goal::SolInfo* i);
+
+    /// @brief Accumulate a contribution from an integration point.
+    /// @param u The displacement component value at the point.
+    /// @param wdv The integration weight times the differential volume.
+    void add_value(double u, double wdv);
+
+    /// @brief Returns the ghost derivative vector to sum into.
+    Teuchos::RCP<goal::Vector> get_ghost_dJdu() { return ghost_dJdu; }
+
+    /// @brief Finalize the accumulated quantities across all ranks.
+    /// @details This exports the ghost derivative to the owned vector,
+    /// reduces the side set measure and scales by its inverse.
+    void post_evaluate();
+
+    /// @brief Returns the most recently computed qoi value.
+    double get_value() { return value; }
+
+    /// @brief Returns the owned derivative of the qoi w.r.t. the DOFs.
+    Teuchos::RCP<goal::Vector> get_dJdu() { return owned_dJdu; }
+
+  private:
+
+    int side_set;
+    int component;
+    double value;
+    double measure;
+    Teuchos::RCP<goal::Vector> ghost_dJdu;
+    Teuchos::RCP<goal::Vector> owned_dJdu;
+    Teuchos::RCP<goal::Export> exporter;
+};
+
+/// @brief Create a quantity of interest.
+/// @param p The qoi parameter list.
+/// @param d The relevant discretization object.
+QoI* create_qoi(ParameterList const& p, goal::Discretization* d);
+
+/// @brief Destroy a quantity of interest.
+/// @param q The \ref ml::QoI object to destroy.
+void destroy_qoi(QoI* q);
+
+} // end namespace ml
+
+#endif
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstdint>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <goal_control.hpp>
+#include <goal_discretization.hpp>
+#include <PCU.h>
+
+#include "ml_sfc.hpp"
+
+namespace ml {
+
+static const int bits = 21;
+
+static uint64_t interleave(uint32_t const* X, int dim) {
+  uint64_t key = 0;
+  for (int b = bits - 1; b >= 0; --b)
+    for (int i = 0; i < dim; ++i)
+      key = (key << 1) | ((X[i] >> b) & 1);
+  return key;
+}
+
+static uint64_t get_morton_key(uint32_t* X, int dim) {
+  return interleave(X, dim);
+}
+
+// J. Skilling, Programming the Hilbert curve, AIP Conf. Proc. 707, 2004
+static uint64_t get_hilbert_key(uint32_t* X, int dim) {
+  uint32_t M = 1u << (bits - 1);
+
+  // inverse undo
+  for (uint32_t Q = M; Q > 1; Q >>= 1) {
+    uint32_t P = Q - 1;
+    for (int i = 0; i < dim; ++i) {
+      if (X[i] & Q) X[0] ^= P;
+      else {
+        uint32_t t = (X[0] ^ X[i]) & P;
+        X[0] ^= t;
+        X[i] ^= t;
+      }
+    }
+  }
+
+  // gray encode
+  for (int i = 1; i < dim; ++i) X[i] ^= X[i - 1];
+  uint32_t t = 0;
+  for (uint32_t Q = M; Q > 1; Q >>= 1)
+    if (X[dim - 1] & Q) t ^= Q - 1;
+  for (int i = 0; i < dim; ++i) X[i] ^= t;
+
+  return interleave(X, dim);
+}
+
+void order_mesh(goal::Discretization* d, std::string const& curve) {
+  auto t0 = PCU_Time();
+  bool is_hilbert = (curve == "hilbert");
+  if ((! is_hilbert) && (curve != "morton"))
+    goal::fail("unknown element order %s", curve.c_str());
+
+  // get the local bounding box
+  apf::Vector3 x;
+  apf::MeshEntity* vtx;
+  auto mesh = d->get_apf_mesh();
+  int dim = mesh->getDimension();
+  apf::Vector3 lo(1.0e300, 1.0e300, 1.0e300);
+  apf::Vector3 hi(-1.0e300, -1.0e300, -1.0e300);
+  std::vector<apf::MeshEntity*> verts;
+  auto it = mesh->begin(0);
+  while ((vtx = mesh->iterate(it))) {
+    mesh->getPoint(vtx, 0, x);
+    for (int i = 0; i < dim; ++i) {
+      lo[i] = std::min(lo[i], x[i]);
+      hi[i] = std::max(hi[i], x[i]);
+    }
+    verts.push_back(vtx);
+  }
+  mesh->end(it);
+
+  // compute the curve index of each vertex
+  double scale = double((1u << bits) - 1);
+  std::vector<std::pair<uint64_t, size_t> > keys(verts.size());
+  for (size_t v = 0; v < verts.size(); ++v) {
+    uint32_t X[3] = {0, 0, 0};
+    mesh->getPoint(verts[v], 0, x);
+    for (int i = 0; i < dim; ++i) {
+      double h = hi[i] - lo[i];
+      double s = (h > 0.0) ? (x[i] - lo[i]) / h : 0.0;
+      X[i] = uint32_t(s * scale);
+    }
+    auto key = is_hilbert ? get_hilbert_key(X, dim) : get_morton_key(X, dim);
+    keys[v] = std::make_pair(key, v);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  // renumber the mesh and rebuild the element and side sets
+  auto tag = mesh->createIntTag("ml_sfc_order", 1);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    int n = int(i);
+    mesh->setIntTag(verts[keys[i].second], tag, &n);
+  }
+  apf::reorderMdsMesh(mesh, tag);
+  apf::removeTagFromDimension(mesh, tag, 0);
+  mesh->destroyTag(tag);
+  d->update();
+
+  auto t1 = PCU_Time();
+  goal::print(" > %s element order in %f seconds", curve.c_str(), t1 - t0);
+}
+
+} // end namespace ml
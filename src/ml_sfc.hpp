@@ -0,0 +1,32 @@
+#ifndef ml_sfc_hpp
+#define ml_sfc_hpp
+
+/// @file ml_sfc.hpp
+
+#include <string>
+
+/// @cond
+namespace goal {
+class Discretization;
+}
+/// @endcond
+
+namespace ml {
+
+/// @brief Order the mesh entities along a space-filling curve.
+/// @param d The relevant discretization object.
+/// @param curve The curve type, `hilbert` or `morton`.
+/// @details The rank-local vertices are sorted by the curve index of
+/// their coordinates in the local bounding box and the mesh is renumbered
+/// in that order. The mesh data structure numbers the edges, faces and
+/// elements by first adjacency to the renumbered vertices, so elements
+/// that are close in space end up close in the element and side sets and
+/// in the worksets formed from them. The DOF numbering follows the same
+/// order and replaces any earlier DOF reordering of the mesh. The
+/// discretization is updated afterwards, so this must be called before
+/// any fields are built.
+void order_mesh(goal::Discretization* d, std::string const& curve);
+
+} // end namespace ml
+
+#endif
@@ -1,5 +1,8 @@
 #include <goal_control.hpp>
+#include "ml_explicit_solver.hpp"
+#include "ml_newmark_solver.hpp"
 #include "ml_static_solver.hpp"
+#include "ml_sweep_solver.hpp"
 
 namespace ml {
 
@@ -15,6 +18,12 @@ Solver* create_solver(ParameterList const& p) {
   Solver* solver = 0;
   if (type == "static")
     solver = new StaticSolver(p);
+  else if (type == "explicit dynamics")
+    solver = new ExplicitSolver(p);
+  else if (type == "newmark")
+    solver = new NewmarkSolver(p);
+  else if (type == "sweep")
+    solver = new SweepSolver(p);
   else
     goal::fail("unknown solver type");
   return solver;
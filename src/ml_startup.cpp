@@ -0,0 +1,146 @@
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <apfMesh2.h>
+#include <goal_control.hpp>
+#include <goal_discretization.hpp>
+#include <PCU.h>
+#include <Teuchos_YamlParameterListHelpers.hpp>
+
+#include "ml_sfc.hpp"
+#include "ml_startup.hpp"
+
+namespace ml {
+
+static std::string broadcast(std::string const& s) {
+  long size = PCU_Comm_Self() ? 0 : s.size();
+  PCU_Add_Longs(&size, 1);
+  std::string out = s;
+  out.resize(size);
+  MPI_Bcast(&out[0], size, MPI_CHAR, 0, PCU_Get_Comm());
+  return out;
+}
+
+ParameterList read_input(std::string const& file) {
+  auto t0 = PCU_Time();
+  std::string contents;
+  long is_open = 0;
+  if (! PCU_Comm_Self()) {
+    std::ifstream in(file.c_str());
+    is_open = in.is_open();
+    std::stringstream ss;
+    ss << in.rdbuf();
+    contents = ss.str();
+  }
+  // every rank fails together when rank 0 cannot read the file
+  PCU_Add_Longs(&is_open, 1);
+  if (! is_open)
+    goal::fail("could not open input file %s", file.c_str());
+  contents = broadcast(contents);
+  ParameterList p;
+  auto pp = Teuchos::Ptr<ParameterList>(&p);
+  Teuchos::updateParametersFromYamlString(contents, pp);
+  auto t1 = PCU_Time();
+  goal::print(" > input time: %f seconds", t1 - t0);
+  return p;
+}
+
+static bool get_stamp(std::string const& file, long* stamp) {
+  struct stat info;
+  if (stat(file.c_str(), &info) != 0) return false;
+  stamp[0] = long(info.st_mtime);
+  stamp[1] = long(info.st_size);
+  return true;
+}
+
+// the modification time and size of the geometry file and of the mesh
+// part file read by each rank, summed over the ranks
+static std::string get_input_stamp(ParameterList const& p) {
+  long stamp[4] = {0, 0, 0, 0};
+  auto geom = p.get<std::string>("geom file");
+  auto mesh = p.get<std::string>("mesh file");
+  if (! PCU_Comm_Self()) get_stamp(geom, stamp);
+  if (! get_stamp(mesh, stamp + 2)) {
+    auto prefix = mesh.substr(0, mesh.rfind(".smb"));
+    auto part = prefix + std::to_string(PCU_Comm_Self()) + ".smb";
+    get_stamp(part, stamp + 2);
+  }
+  PCU_Add_Longs(stamp, 4);
+  std::stringstream ss;
+  ss << stamp[0] << " " << stamp[1] << " " << stamp[2] << " " << stamp[3];
+  return ss.str();
+}
+
+static ParameterList get_manifest(ParameterList p) {
+  ParameterList manifest;
+  manifest.set<std::string>("geom file", p.get<std::string>("geom file"));
+  manifest.set<std::string>("mesh file", p.get<std::string>("mesh file"));
+  manifest.set<std::string>("input stamp", get_input_stamp(p));
+  manifest.set<bool>("reorder mesh", p.get<bool>("reorder mesh", false));
+  manifest.set<std::string>("element order",
+      p.get<std::string>("element order", "mesh"));
+  manifest.set<int>("ranks", PCU_Comm_Peers());
+  return manifest;
+}
+
+static bool is_cached(std::string const& cache, ParameterList const& m) {
+  int is_valid = 0;
+  if (! PCU_Comm_Self()) {
+    std::ifstream in((cache + ".yaml").c_str());
+    if (in.is_open()) {
+      in.close();
+      auto cached = Teuchos::getParametersFromYamlFile(cache + ".yaml");
+      is_valid = (*cached == m) ? 1 : 0;
+    }
+  }
+  return PCU_Max_Int(is_valid) == 1;
+}
+
+static goal::Discretization* build_disc(ParameterList dp) {
+  auto order = dp.get<std::string>("element order", "mesh");
+  dp.remove("element order");
+  if ((order != "mesh") && dp.get<bool>("reorder mesh", false))
+    goal::fail("element order %s replaces reorder mesh", order.c_str());
+  auto d = goal::create_disc(dp);
+  if (order != "mesh") ml::order_mesh(d, order);
+  return d;
+}
+
+goal::Discretization* create_disc(ParameterList const& p) {
+  auto t0 = PCU_Time();
+  auto dp = p;
+  if (! dp.isType<std::string>("cache file")) {
+    auto d = build_disc(dp);
+    auto t1 = PCU_Time();
+    goal::print(" > discretization time: %f seconds", t1 - t0);
+    return d;
+  }
+
+  // load the cached mesh if it was built from the same inputs
+  auto cache = dp.get<std::string>("cache file");
+  dp.remove("cache file");
+  auto manifest = get_manifest(dp);
+  bool use_cache = is_cached(cache, manifest);
+  if (use_cache) {
+    dp.set<std::string>("mesh file", cache + ".smb");
+    dp.set<bool>("reorder mesh", false);
+    dp.set<std::string>("element order", "mesh");
+  }
+  auto d = build_disc(dp);
+  auto t1 = PCU_Time();
+
+  // otherwise write the cache for the next run
+  if (! use_cache) {
+    d->get_apf_mesh()->writeNative((cache + ".smb").c_str());
+    if (! PCU_Comm_Self())
+      Teuchos::writeParameterListToYamlFile(manifest, cache + ".yaml");
+  }
+  auto t2 = PCU_Time();
+  goal::print(" > discretization time: %f seconds (%s)",
+      t1 - t0, use_cache ? "cached" : "built");
+  if (! use_cache)
+    goal::print(" > discretization cache write: %f seconds", t2 - t1);
+  return d;
+}
+
+} // end namespace ml
@@ -0,0 +1,46 @@
+#ifndef ml_startup_hpp
+#define ml_startup_hpp
+
+/// @file ml_startup.hpp
+
+#include <Teuchos_ParameterList.hpp>
+
+/// @cond
+namespace goal {
+class Discretization;
+}
+/// @endcond
+
+namespace ml {
+
+using Teuchos::ParameterList;
+
+/// @brief Read the YAML input file.
+/// @param file The path to the input file.
+/// @details Only rank 0 touches the file system. It reads the file and
+/// broadcasts its contents, which every rank then parses in memory.
+ParameterList read_input(std::string const& file);
+
+/// @brief Create a discretization, optionally through a mesh cache.
+/// @param p The discretization parameter list.
+/// @details An `element order` of `hilbert` or `morton` renumbers
+/// the mesh along that space-filling curve with \ref ml::order_mesh
+/// after it is read. The default `mesh` keeps the order of the mesh.
+/// The curve renumbers the vertices and so the DOFs as well, which
+/// would undo the `reorder mesh` DOF ordering, so the two options are
+/// mutually exclusive.
+///
+/// If the parameter list has a `cache file` prefix, the
+/// reordered, partitioned mesh is written in the native per-rank binary
+/// format on the first run, along with a manifest of the inputs it was
+/// built from. Later runs with the same geometry, mesh, orderings and
+/// number of ranks load the cached mesh and skip the reordering. The
+/// manifest also records the modification times and sizes of the
+/// geometry and mesh files, so an edited mesh forces a rebuild. The
+/// association file is small and is always read. Remove the cache files
+/// to force a rebuild.
+goal::Discretization* create_disc(ParameterList const& p);
+
+} // end namespace ml
+
+#endif
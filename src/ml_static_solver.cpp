@@ -1,13 +1,27 @@
+#include <apf.h>
 #include <goal_assembly.hpp>
 #include <goal_control.hpp>
 #include <goal_dbcs.hpp>
 #include <goal_discretization.hpp>
-#include <goal_linear_solvers.hpp>
 #include <goal_indexer.hpp>
 #include <goal_output.hpp>
 #include <goal_sol_info.hpp>
+#include <PCU.h>
 
+#include "ml_adapt.hpp"
+#include "ml_anderson.hpp"
+#include "ml_async_output.hpp"
+#include "ml_checkpoint.hpp"
+#include "ml_condense.hpp"
+#include "ml_continuation.hpp"
+#include "ml_error.hpp"
+#include "ml_linear_algebra.hpp"
+#include "ml_linear_solver.hpp"
 #include "ml_mechanics.hpp"
+#include "ml_memory.hpp"
+#include "ml_qoi.hpp"
+#include "ml_startup.hpp"
+#include "ml_stress_output.hpp"
 #include "ml_static_solver.hpp"
 
 namespace ml {
@@ -17,10 +31,36 @@ static ParameterList get_valid_params() {
   p.set<std::string>("solver type", "");
   p.set<int>("nonlinear max iters", 0);
   p.set<double>("nonlinear tolerance", 0.0);
+  p.set<std::string>("restart from", "");
+  p.set<bool>("static condensation", false);
+  p.set<bool>("p continuation", false);
+  p.set<bool>("memory statistics", false);
   p.sublist("discretization");
   p.sublist("mechanics");
   p.sublist("output");
   p.sublist("linear algebra");
+  p.sublist("adaptation");
+  p.sublist("checkpoint");
+  p.sublist("time series");
+  p.sublist("newmark");
+  p.sublist("sweep");
+  p.sublist("anderson");
+  return p;
+}
+
+static ParameterList get_valid_anderson_params() {
+  ParameterList p;
+  p.set<int>("window size", 0);
+  p.set<double>("mixing", 0.0);
+  p.set<int>("jacobian interval", 0);
+  return p;
+}
+
+static ParameterList get_valid_adapt_params() {
+  ParameterList p;
+  p.set<int>("cycles", 0);
+  p.set<double>("target error", 0.0);
+  p.set<int>("adapt iters", 0);
   return p;
 }
 
@@ -30,6 +70,19 @@ static void validate_params(ParameterList const& p) {
   GOAL_ALWAYS_ASSERT(p.isSublist("output"));
   GOAL_ALWAYS_ASSERT(p.isSublist("linear algebra"));
   p.validateParameters(get_valid_params(), 0);
+  if (p.isSublist("anderson")) {
+    bool is_condensed = p.isType<bool>("static condensation") &&
+      p.get<bool>("static condensation");
+    GOAL_ALWAYS_ASSERT(! is_condensed);
+    auto ap = p.sublist("anderson");
+    ap.validateParameters(get_valid_anderson_params(), 0);
+  }
+  if (! p.isSublist("adaptation")) return;
+  auto ap = p.sublist("adaptation");
+  GOAL_ALWAYS_ASSERT(ap.isType<int>("cycles"));
+  GOAL_ALWAYS_ASSERT(ap.isType<double>("target error"));
+  GOAL_ALWAYS_ASSERT(p.sublist("mechanics").isSublist("qoi"));
+  ap.validateParameters(get_valid_adapt_params(), 0);
 }
 
 StaticSolver::StaticSolver(ParameterList const& p)
@@ -37,95 +90,474 @@ StaticSolver::StaticSolver(ParameterList const& p)
       disc(0),
       mech(0),
       info(0),
-      out(0) {
+      out(0),
+      series(0),
+      linear_solver(0),
+      condensation(0),
+      has_model(false),
+      track_memory(false),
+      reuse_tangent(false),
+      needs_tangent(true),
+      is_tangent_current(false),
+      is_mesh_changed(false),
+      num_tangents(0),
+      start_step(0),
+      contraction(0.5),
+      assembly_time(0.0),
+      error_bound(0.0) {
   validate_params(params);
   auto dp = params.sublist("discretization");
   auto mp = params.sublist("mechanics");
   auto op = params.sublist("output");
-  disc = goal::create_disc(dp);
+  ParameterList manifest;
+  bool is_restart = params.isType<std::string>("restart from");
+  if (is_restart) {
+    auto file = params.get<std::string>("restart from");
+    manifest = ml::read_checkpoint_manifest(file);
+    auto mesh_file = manifest.get<std::string>("mesh file");
+    if (mesh_file != "") dp.set<std::string>("mesh file", mesh_file);
+    if (mesh_file != "") dp.remove("cache file", false);
+    is_mesh_changed = (mesh_file != "");
+  }
+  track_memory = params.get<bool>("memory statistics", false);
+  disc = ml::create_disc(dp);
+  if (track_memory) ml::print_memory("discretization");
   out = goal::create_output(op, disc);
   mech = ml::create_mech(mp, disc);
+  if (track_memory) ml::print_states_memory(mech, disc);
+  if (track_memory) ml::print_memory("mechanics");
+  linear_solver = ml::create_linear_solver(params.sublist("linear algebra"));
+  linear_solver->set_memory_tracking(track_memory);
+  if (params.isSublist("time series"))
+    series = ml::create_async_output(params.sublist("time series"), disc);
+  if (is_restart)
+    start_step = ml::read_checkpoint(manifest, mech, disc, restart_fields);
   auto model = mp.get<std::string>("model");
   is_linear = (model == "elastic");
+  if (linear_solver->is_symmetric() && (! is_linear))
+    goal::fail("symmetric matrix storage needs the elastic model");
+  is_adaptive = params.isSublist("adaptation");
+  use_continuation = params.get<bool>("p continuation", false);
+  use_continuation = use_continuation && (! is_restart);
+  use_continuation = use_continuation && (mech->get_p_order() > 1);
+  if (is_adaptive)
+    params.sublist("adaptation").get<int>("adapt iters", 3);
+  if (params.isSublist("anderson")) {
+    auto& ap = params.sublist("anderson");
+    ap.get<int>("window size", 5);
+    ap.get<double>("mixing", 1.0);
+    ap.get<int>("jacobian interval", 0);
+  }
 }
 
 StaticSolver::~StaticSolver() {
+  for (size_t i = 0; i < restart_fields.size(); ++i)
+    apf::destroyField(restart_fields[i]);
+  destroy_primal_data();
+  if (series) ml::destroy_async_output(series);
+  ml::destroy_linear_solver(linear_solver);
   ml::destroy_mech(mech);
   goal::destroy_output(out);
   goal::destroy_disc(disc);
 }
 
+void StaticSolver::compute_primal_residual() {
+  auto qoi = mech->get_qoi();
+  if (qoi) qoi->pre_evaluate(info);
+  goal::compute_primal_residual(mech, info, disc, 0, 0);
+  if (! qoi) return;
+  qoi->post_evaluate();
+  goal::print(" > J(u) = %.15e", qoi->get_value());
+}
+
 void StaticSolver::solve_linear_primal() {
   auto indexer = mech->get_indexer();
-  goal::compute_primal_jacobian(mech, info, disc, 0, 0);
+  assemble_primal(0.0, 0.0, true);
   auto R = info->owned->R;
   auto dRdu = info->owned->dRdu;
   auto du = info->owned->du;
   du->putScalar(0.0);
   R->scale(-1.0);
-  auto lp = params.sublist("linear algebra");
-  goal::solve_linear_system(lp, dRdu, du, R, indexer);
-  indexer->add_to_fields(mech->get_u(), du);
-  goal::compute_primal_residual(mech, info, disc, 0, 0);
+  if (condensation) condensation->solve(linear_solver, du);
+  else linear_solver->solve(dRdu, du, R, indexer);
+  add_to_primal();
+  compute_primal_residual();
+}
+
+void StaticSolver::assemble_primal(double t, double dt, bool with_tangent) {
+  auto t0 = PCU_Time();
+  if (with_tangent) {
+    goal::compute_primal_jacobian(mech, info, disc, t, dt);
+    linear_solver->reset_preconditioner();
+    is_tangent_current = true;
+    num_tangents++;
+  } else {
+    goal::compute_primal_residual(mech, info, disc, t, dt);
+  }
+  assembly_time += PCU_Time() - t0;
+}
+
+void StaticSolver::add_to_primal() {
+  auto indexer = mech->get_indexer();
+  indexer->add_to_fields(mech->get_u(), info->owned->du);
+  is_tangent_current = false;
 }
 
-void StaticSolver::solve_nonlinear_primal() {
+int StaticSolver::solve_newton(double t, double dt) {
 
   // get useful parameters
-  auto indexer = mech->get_indexer();
-  auto lp = params.sublist("linear algebra");
   auto max = params.get<int>("nonlinear max iters");
   auto tol = params.get<double>("nonlinear tolerance");
   auto R = info->owned->R;
   auto du = info->owned->du;
   auto dRdu = info->owned->dRdu;
 
-  // solve with newton's method
+  // solve with newton's method. the convergence check only needs the
+  // residual, and the tangent is assembled once an iteration is needed.
+  // a kept tangent is reassembled as soon as a frozen iteration fails
+  // to contract the residual
+  double norm_old = 0.0;
+  for (int iter = 0; iter <= max; ++iter) {
+    if (iter > 0) goal::print(" > (%d) newton iteration", iter);
+    assemble_primal(t, dt, false);
+    double norm = R->norm2();
+    goal::print(" > ||R|| = %e", norm);
+    if (norm < tol) return iter;
+    if (iter == max) break;
+    bool is_fresh = needs_tangent || (! reuse_tangent);
+    bool is_slow = (iter > 0) && (norm > contraction * norm_old);
+    if (is_fresh || is_slow) assemble_primal(t, dt, true);
+    needs_tangent = false;
+    norm_old = norm;
+    R->scale(-1.0);
+    du->putScalar(0.0);
+    if (condensation) condensation->solve(linear_solver, du);
+    else linear_solver->solve(dRdu, du, R);
+    add_to_primal();
+  }
+
+  // die if no convergence
+  goal::fail("newton's method failed in %d iterations", max);
+  return -1;
+}
+
+int StaticSolver::solve_nonlinear_primal() {
+  if (params.isSublist("anderson")) return solve_anderson_primal();
+  assembly_time = 0.0;
+  needs_tangent = true;
+  int iters = solve_newton(0.0, 0.0);
+  if (mech->get_qoi()) compute_primal_residual();
+  goal::print(" > jacobian assembly time: %f seconds", assembly_time);
+  return iters;
+}
+
+int StaticSolver::solve_anderson_primal() {
+
+  // get useful parameters
+  auto max = params.get<int>("nonlinear max iters");
+  auto tol = params.get<double>("nonlinear tolerance");
+  auto ap = params.sublist("anderson");
+  auto interval = ap.get<int>("jacobian interval");
+  auto R = info->owned->R;
+  auto du = info->owned->du;
+  auto dRdu = info->owned->dRdu;
+  auto f = Teuchos::rcp(new goal::Vector(R->getMap()));
+  auto window = ap.get<int>("window size");
+  auto mixing = ap.get<double>("mixing");
+  auto anderson = ml::create_anderson(R->getMap(), window, mixing);
+  linear_solver->set_preconditioner_reuse(true);
+
+  // accelerate the fixed point iteration of the frozen jacobian. the
+  // jacobian is reassembled every interval iterations, or as soon as
+  // the residual norm grows
   int iter = 1;
+  int num_assemblies = 0;
+  int num_solves = 0;
   bool converged = false;
+  bool needs_jacobian = true;
+  double norm_old = 0.0;
+  assembly_time = 0.0;
   while ((iter <= max) && (! converged)) {
-    goal::print(" > (%d) newton iteration", iter);
-    goal::compute_primal_jacobian(mech, info, disc, 0, 0);
+    goal::print(" > (%d) anderson iteration", iter);
+    if (needs_jacobian) {
+      assemble_primal(0.0, 0.0, true);
+      anderson->reset();
+      needs_jacobian = false;
+      num_assemblies++;
+    }
     R->scale(-1.0);
-    du->putScalar(0.0);
-    goal::solve_linear_system(lp, dRdu, du, R);
-    indexer->add_to_fields(mech->get_u(), du);
-    goal::compute_primal_residual(mech, info, disc, 0, 0);
+    f->putScalar(0.0);
+    linear_solver->solve(dRdu, f, R);
+    num_solves++;
+    anderson->compute_step(f, du);
+    add_to_primal();
+    compute_primal_residual();
     double norm = R->norm2();
-    goal::print(" > ||R|| = %e", norm);
+    goal::print(" > ||R|| = %e (depth %d)", norm, anderson->get_depth());
     if (norm < tol)
       converged = true;
+    if ((interval > 0) && (iter % interval == 0))
+      needs_jacobian = true;
+    if ((iter > 1) && (norm > norm_old))
+      needs_jacobian = true;
+    norm_old = norm;
     iter++;
   }
+  linear_solver->set_preconditioner_reuse(false);
+  linear_solver->reset_preconditioner();
+  ml::destroy_anderson(anderson);
 
   // die if no convergence
   if ((iter > max) && (! converged))
-    goal::fail("newton's method failed in %d iterations", max);
+    goal::fail("anderson iteration failed in %d iterations", max);
+  goal::print(" > jacobian assemblies: %d", num_assemblies);
+  goal::print(" > linear solves: %d", num_solves);
+  goal::print(" > jacobian assembly time: %f seconds", assembly_time);
+  return iter - 1;
+}
+
+void StaticSolver::build_primal_data() {
+
+  // the indexer, the matrix graph and the model persist until the
+  // mesh changes, so repeated solves only refill the matrix values
+  if (info && has_model) return;
+  auto t0 = PCU_Time();
+  if (! info) {
+    mech->build_coarse_indexer();
+    info = goal::create_sol_info(mech->get_indexer(), 0);
+    if (track_memory) print_jacobian_memory();
+    if (linear_solver->needs_null_space())
+      linear_solver->set_null_space(ml::build_rigid_body_modes(mech, info));
+    if (linear_solver->needs_node_blocks()) {
+      auto ids = ml::build_node_block_ids(mech, info);
+      linear_solver->set_node_blocks(ids, mech->get_u().size());
+    }
+    if (linear_solver->needs_prolongation()) {
+      if (mech->get_p_order() < 2) goal::fail("p-multigrid needs p > 1");
+      linear_solver->set_prolongation(ml::build_p1_prolongation(mech, info));
+    }
+    if (params.get<bool>("static condensation", false))
+      build_condensation();
+  }
+  if (! has_model) {
+    mech->build_primal_model();
+    has_model = true;
+    if (track_memory) ml::print_memory("model build");
+  }
+  auto t1 = PCU_Time();
+  goal::print(" > num dofs: %lu", info->owned->R->getGlobalLength());
+  goal::print(" > primal setup time: %f seconds", t1 - t0);
+}
+
+void StaticSolver::print_jacobian_memory() {
+  ml::print_matrix_memory("owned jacobian", info->owned->dRdu);
+  ml::print_matrix_memory("ghost jacobian", info->ghost->dRdu);
+  ml::print_memory("jacobian allocation");
+}
+
+void StaticSolver::build_condensation() {
+  auto indexer = mech->get_indexer();
+  auto c = ml::create_condensation(indexer, info, mech->get_u());
+  if (c->is_active()) condensation = c;
+  else ml::destroy_condensation(c);
+}
+
+void StaticSolver::destroy_primal_data() {
+  if (condensation) ml::destroy_condensation(condensation);
+  condensation = 0;
+  linear_solver->set_null_space(Teuchos::null);
+  linear_solver->set_prolongation(Teuchos::null);
+  linear_solver->set_node_blocks(Teuchos::null, 0);
+  linear_solver->reset_recycling();
+  if (has_model) mech->destroy_model();
+  if (info) {
+    goal::destroy_sol_info(info);
+    mech->destroy_indexer();
+  }
+  has_model = false;
+  is_tangent_current = false;
+  info = 0;
 }
 
-void StaticSolver::solve_primal() {
+int StaticSolver::solve_primal() {
   goal::print("*** primal problem");
 
-  // build + assemble the primal data
-  mech->build_coarse_indexer();
-  mech->build_primal_model();
+  // build or reuse the primal data
+  build_primal_data();
   goal::set_dbc_values(mech, 0.0);
-  info = goal::create_sol_info(mech->get_indexer(), 0);
 
   // solve the linear algebra problem
+  auto t0 = PCU_Time();
   if (is_linear) solve_linear_primal();
-  solve_nonlinear_primal();
+  int iters = solve_nonlinear_primal();
+  auto t1 = PCU_Time();
+  goal::print(" > newton iterations: %d", iters);
+  goal::print(" > primal solve time: %f seconds", t1 - t0);
+  if (track_memory) ml::print_memory("primal solve");
+  return iters;
+}
+
+void StaticSolver::solve_p1_guess() {
+  goal::print("*** p1 continuation");
+
+  // the p1 solve uses the p-multigrid coarse level solver, if any
+  auto lp = params.sublist("linear algebra");
+  if (lp.isSublist("p-multigrid"))
+    lp = lp.sublist("p-multigrid").sublist("coarse");
+  auto high_order_solver = linear_solver;
+  linear_solver = ml::create_linear_solver(lp);
+  linear_solver->set_memory_tracking(track_memory);
+
+  // the p1 and high order mechanics share field and state names, so
+  // the high order mechanics is rebuilt after the p1 solve. only the
+  // displacement is carried over: the history states of the single
+  // load step are recomputed from the initial old states anyway.
+  auto mp = params.sublist("mechanics");
+  auto p1 = mp;
+  p1.set<int>("p order", 1);
+  p1.set<std::string>("formulation", "displacement");
+  ml::destroy_mech(mech);
+  mech = ml::create_mech(p1, disc);
+  solve_primal();
+  auto u1 = ml::save_p1_displacement(mech);
+  destroy_primal_data();
+  ml::destroy_mech(mech);
+  mech = ml::create_mech(mp, disc);
+  ml::interpolate_p1_displacement(u1, mech);
+  ml::destroy_linear_solver(linear_solver);
+  linear_solver = high_order_solver;
+}
+
+void StaticSolver::solve_dual() {
+  goal::print("*** dual problem");
+
+  // the adjoint is linearized at the converged primal solution. a
+  // frozen anderson jacobian belongs to an earlier iterate
+  if (! is_tangent_current) assemble_primal(0.0, 0.0, true);
+
+  // the dual right hand side is the qoi derivative
+  auto qoi = mech->get_qoi();
+  auto indexer = mech->get_indexer();
+  auto dRdu = info->owned->dRdu;
+  auto dbc_rows = get_dbc_rows(dRdu);
+  auto dJdu = Teuchos::rcp(new goal::Vector(*(qoi->get_dJdu())));
+  auto z = Teuchos::rcp(new goal::Vector(dJdu->getMap()));
+  {
+    auto g = dJdu->getDataNonConst();
+    auto is_dbc = dbc_rows->getData();
+    for (size_t i = 0; i < dJdu->getLocalLength(); ++i)
+      if (is_dbc[i] != 0.0) g[i] = 0.0;
+  }
+
+  // for the symmetric small strain elastic operator the transpose of
+  // the primal jacobian is the operator itself.
+  auto dRduT = (is_linear) ? dRdu : get_transpose(dRdu, dbc_rows);
+  z->putScalar(0.0);
+  linear_solver->solve(dRduT, z, dJdu, indexer);
+  indexer->add_to_fields(mech->get_z(), z);
+}
+
+void StaticSolver::estimate_error() {
+  goal::print("*** error estimation");
 
-  // finalize the primal data
-  goal::destroy_sol_info(info);
+  // recover the enriched dual weights by patch least squares
+  ml::recover_dual_weights(mech, disc);
+
+  // evaluate the element-wise dual weighted residuals
+  if (has_model) mech->destroy_model();
+  has_model = false;
+  apf::zeroField(mech->get_error_field());
+  mech->build_error_model();
+  goal::compute_error_residual(mech, info, disc, 0, 0);
   mech->destroy_model();
-  mech->destroy_indexer();
+  ml::destroy_side_weights(disc);
+
+  double eta = ml::sum_error(mech, disc, error_bound);
+  goal::print(" > J(u) - J(u_h) ~ %.15e", eta);
+  goal::print(" > |J(u) - J(u_h)| <= %.15e", error_bound);
+}
+
+void StaticSolver::adapt_mesh() {
+  goal::print("*** mesh adaptation");
+  destroy_primal_data();
+  ml::adapt_mesh(params.sublist("adaptation"), mech, disc);
+}
+
+void StaticSolver::recover_stress() {
+  auto stress = mech->get_stress_output();
+  if (! stress) return;
+  build_primal_data();
+  stress->begin();
+  compute_primal_residual();
+  stress->end();
+}
+
+void StaticSolver::write_output(int step, double t) {
+  recover_stress();
+  if (series) series->write(step, t);
+  else out->write(step);
+  if (track_memory) ml::print_memory("output");
+}
+
+bool StaticSolver::should_checkpoint(int step, bool is_done) {
+  if (! params.isSublist("checkpoint")) return false;
+  auto interval = params.sublist("checkpoint").get<int>("interval");
+  return (interval > 0) && ((step % interval == 0) || is_done);
 }
 
 void StaticSolver::solve() {
   goal::print("solving");
-  solve_primal();
-  out->write(0);
+  int cycles = 1;
+  double target = 0.0;
+  double dof_time = 0.0;
+  if (is_adaptive) {
+    auto ap = params.sublist("adaptation");
+    cycles = ap.get<int>("cycles");
+    target = ap.get<double>("target error");
+  }
+
+  if (start_step > 0)
+    goal::print(" > restarted after step %d of %d", start_step, cycles);
+
+  for (int cycle = start_step; cycle < cycles; ++cycle) {
+    if (is_adaptive) goal::print("** adaptive cycle %d", cycle);
+    auto t0 = PCU_Time();
+
+    // solve and estimate the error
+    if (use_continuation && (cycle == 0)) solve_p1_guess();
+    auto qoi = mech->get_qoi();
+    solve_primal();
+    if (qoi) solve_dual();
+    if (qoi) estimate_error();
+    double num_dofs = info->owned->R->getGlobalLength();
+    write_output(cycle, cycle);
+    auto t1 = PCU_Time();
+    dof_time += num_dofs * (t1 - t0);
+
+    // adapt the mesh if the target has not been met
+    bool is_done = (! is_adaptive) || (cycle == cycles - 1);
+    if (is_adaptive) {
+      goal::print(" > cumulative dof-seconds: %e", dof_time);
+      if (error_bound < target) {
+        goal::print(" > target error %e reached", target);
+        is_done = true;
+      }
+    }
+    if (! is_done) adapt_mesh();
+
+    // checkpoint the state the next cycle starts from, a finished run
+    // restarts after its last cycle and solves nothing
+    int step = is_done ? cycles : cycle + 1;
+    if (should_checkpoint(step, is_done)) {
+      auto cp = params.sublist("checkpoint");
+      bool is_adapted = is_adaptive && ((cycle > 0) || (! is_done));
+      ml::write_checkpoint(cp, step, mech, disc,
+          is_adapted || is_mesh_changed);
+    }
+    if (is_done) break;
+  }
+  if (linear_solver->get_num_iters() > 0)
+    goal::print(" > krylov iterations: %ld", linear_solver->get_num_iters());
 }
 
 } // end namespace ml
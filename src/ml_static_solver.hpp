@@ -3,10 +3,15 @@
 
 /// @file ml_static_solver.hpp
 
+#include <vector>
 #include <Teuchos_ParameterList.hpp>
 #include "ml_solver.hpp"
 
 /// @cond
+namespace apf {
+class Field;
+}
+
 namespace goal {
 class Discretization;
 class SolInfo;
@@ -20,6 +25,9 @@ using Teuchos::ParameterList;
 
 /// @cond
 class Mechanics;
+class AsyncOutput;
+class Condensation;
+class LinearSolver;
 /// @endcond
 
 /// @brief An interface to solve static problems.
@@ -37,23 +45,56 @@ class StaticSolver : public Solver {
     /// @brief Run the solver
     void solve();
 
-  private:
+  protected:
+
+    void build_primal_data();
+    void destroy_primal_data();
+    void build_condensation();
+    void print_jacobian_memory();
 
-    void solve_primal();
+    virtual void assemble_primal(double t, double dt, bool with_tangent);
+    virtual void add_to_primal();
+    int solve_newton(double t, double dt);
+
+    void compute_primal_residual();
+    int solve_primal();
     void solve_linear_primal();
-    void solve_nonlinear_primal();
+    int solve_nonlinear_primal();
+    int solve_anderson_primal();
+    void solve_p1_guess();
 
     void solve_dual();
     void estimate_error();
     void adapt_mesh();
 
+    bool should_checkpoint(int step, bool is_done);
+    void recover_stress();
+    void write_output(int step, double t);
+
     ParameterList params;
     goal::Discretization* disc;
     ml::Mechanics* mech;
     goal::SolInfo* info;
     goal::Output* out;
+    ml::AsyncOutput* series;
+    ml::LinearSolver* linear_solver;
+    ml::Condensation* condensation;
 
     bool is_linear;
+    bool is_adaptive;
+    bool use_continuation;
+    bool has_model;
+    bool track_memory;
+    bool reuse_tangent;
+    bool needs_tangent;
+    bool is_tangent_current;
+    bool is_mesh_changed;
+    int num_tangents;
+    int start_step;
+    std::vector<apf::Field*> restart_fields;
+    double contraction;
+    double assembly_time;
+    double error_bound;
 };
 
 } // end namespace ml
@@ -0,0 +1,126 @@
+#include <apf.h>
+#include <apfMesh.h>
+#include <goal_control.hpp>
+#include <goal_discretization.hpp>
+
+#include "ml_stress_output.hpp"
+
+namespace ml {
+
+StressOutput::StressOutput(goal::Discretization* d, int q, bool n)
+    : disc(d),
+      q_degree(q),
+      is_nodal(n),
+      active(false),
+      cell(0),
+      nodal(0),
+      mass(0) {
+}
+
+StressOutput::~StressOutput() {
+  destroy_fields();
+}
+
+void StressOutput::destroy_fields() {
+  if (cell) apf::destroyField(cell);
+  if (nodal) apf::destroyField(nodal);
+  if (mass) apf::destroyField(mass);
+  cell = 0;
+  nodal = 0;
+  mass = 0;
+}
+
+void StressOutput::begin() {
+  auto mesh = disc->get_apf_mesh();
+  auto shape = apf::getConstant(mesh->getDimension());
+  if (! cell) cell = apf::createField(mesh, "cauchy", apf::MATRIX, shape);
+  apf::zeroField(cell);
+  if (is_nodal) {
+    if (! nodal) nodal = apf::createFieldOn(mesh, "cauchy_nodal", apf::MATRIX);
+    if (! mass) mass = apf::createFieldOn(mesh, "lumped_mass", apf::SCALAR);
+    apf::zeroField(nodal);
+    apf::zeroField(mass);
+  }
+  active = true;
+}
+
+void StressOutput::add(
+    apf::MeshEntity* e,
+    std::vector<minitensor::Tensor<double> > const& sigma,
+    std::vector<double> const& wdv) {
+
+  // accumulate the volume integral of the stress
+  auto mesh = disc->get_apf_mesh();
+  auto dim = mesh->getDimension();
+  int num_ips = sigma.size();
+  std::vector<apf::Matrix3x3> s(num_ips, apf::Matrix3x3(0,0,0,0,0,0,0,0,0));
+  apf::Matrix3x3 s_elem(0, 0, 0, 0, 0, 0, 0, 0, 0);
+  for (int ip = 0; ip < num_ips; ++ip) {
+    for (int i = 0; i < dim; ++i)
+    for (int j = 0; j < dim; ++j)
+      s[ip][i][j] = sigma[ip](i, j);
+    s_elem = s_elem + s[ip] * wdv[ip];
+  }
+  apf::setMatrix(cell, e, 0, s_elem);
+  if (! is_nodal) return;
+
+  // accumulate the lumped projection with the linear basis
+  apf::Vector3 xi;
+  apf::Matrix3x3 s_vtx;
+  apf::NewArray<double> N;
+  apf::Downward verts;
+  int num_verts = mesh->getDownward(e, 0, verts);
+  auto me = apf::createMeshElement(mesh, e);
+  auto elem = apf::createElement(mass, me);
+  for (int ip = 0; ip < num_ips; ++ip) {
+    apf::getIntPoint(me, q_degree, ip, xi);
+    apf::getShapeValues(elem, xi, N);
+    for (int v = 0; v < num_verts; ++v) {
+      apf::getMatrix(nodal, verts[v], 0, s_vtx);
+      apf::setMatrix(nodal, verts[v], 0, s_vtx + s[ip] * (N[v] * wdv[ip]));
+      double m = apf::getScalar(mass, verts[v], 0);
+      apf::setScalar(mass, verts[v], 0, m + N[v] * wdv[ip]);
+    }
+  }
+  apf::destroyElement(elem);
+  apf::destroyMeshElement(me);
+}
+
+void StressOutput::end() {
+  apf::MeshEntity* ent;
+  apf::Matrix3x3 s;
+  auto mesh = disc->get_apf_mesh();
+
+  // normalize the element averages
+  auto it = mesh->begin(mesh->getDimension());
+  while ((ent = mesh->iterate(it))) {
+    apf::getMatrix(cell, ent, 0, s);
+    apf::setMatrix(cell, ent, 0, s / apf::measure(mesh, ent));
+  }
+  mesh->end(it);
+
+  // complete the lumped projection across the part boundaries
+  if (is_nodal) {
+    apf::accumulate(nodal);
+    apf::accumulate(mass);
+    it = mesh->begin(0);
+    while ((ent = mesh->iterate(it))) {
+      apf::getMatrix(nodal, ent, 0, s);
+      apf::setMatrix(nodal, ent, 0, s / apf::getScalar(mass, ent, 0));
+    }
+    mesh->end(it);
+  }
+
+  active = false;
+}
+
+StressOutput* create_stress_output(
+    goal::Discretization* d, int q, bool nodal) {
+  return new StressOutput(d, q, nodal);
+}
+
+void destroy_stress_output(StressOutput* s) {
+  delete s;
+}
+
+} // end namespace ml
@@ -0,0 +1,88 @@
+#ifndef ml_stress_output_hpp
+#define ml_stress_output_hpp
+
+/// @file ml_stress_output.hpp
+
+#include <MiniTensor.h>
+
+/// @cond
+namespace apf {
+class Field;
+class MeshEntity;
+}
+
+namespace goal {
+class Discretization;
+}
+/// @endcond
+
+namespace ml {
+
+/// @brief Output fields for the recovered Cauchy stress.
+/// @details The Cauchy stress is not stored during nonlinear iterations.
+/// Instead, it is recovered in a single residual evaluation when output
+/// is written. The element average stress is always recovered. The
+/// stress can optionally be projected to the mesh vertices with a lumped
+/// L2 projection.
+class StressOutput {
+
+  public:
+
+    /// @brief Construct the stress output fields.
+    /// @param d The relevant discretization object.
+    /// @param q The integration degree.
+    /// @param nodal True if a lumped L2 nodal projection is desired.
+    StressOutput(goal::Discretization* d, int q, bool nodal);
+
+    /// @brief Destroy the stress output fields.
+    ~StressOutput();
+
+    /// @brief Returns true during a stress recovery pass.
+    bool is_active() { return active; }
+
+    /// @brief Begin a stress recovery pass.
+    /// @details This (re)creates and zeros the stress fields.
+    void begin();
+
+    /// @brief Add the stress contributions from an element.
+    /// @param e The element.
+    /// @param sigma The Cauchy stress at each integration point.
+    /// @param wdv The weighted differential volume at each point.
+    void add(
+        apf::MeshEntity* e,
+        std::vector<minitensor::Tensor<double> > const& sigma,
+        std::vector<double> const& wdv);
+
+    /// @brief End a stress recovery pass.
+    /// @details This normalizes the element averages and completes the
+    /// lumped projection across all ranks.
+    void end();
+
+    /// @brief Destroy the stress fields prior to a mesh change.
+    void destroy_fields();
+
+  private:
+
+    goal::Discretization* disc;
+    int q_degree;
+    bool is_nodal;
+    bool active;
+    apf::Field* cell;
+    apf::Field* nodal;
+    apf::Field* mass;
+};
+
+/// @brief Create the stress output fields.
+/// @param d The relevant discretization object.
+/// @param q The integration degree.
+/// @param nodal True if a lumped L2 nodal projection is desired.
+StressOutput* create_stress_output(
+    goal::Discretization* d, int q, bool nodal);
+
+/// @brief Destroy the stress output fields.
+/// @param s The \ref ml::StressOutput object to destroy.
+void destroy_stress_output(StressOutput* s);
+
+} // end namespace ml
+
+#endif
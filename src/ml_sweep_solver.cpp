@@ -0,0 +1,143 @@
+#include <apf.h>
+#include <fstream>
+#include <goal_control.hpp>
+#include <goal_field.hpp>
+#include <goal_sol_info.hpp>
+#include <PCU.h>
+
+#include "ml_linear_solver.hpp"
+#include "ml_mechanics.hpp"
+#include "ml_qoi.hpp"
+#include "ml_sweep_solver.hpp"
+
+namespace ml {
+
+using Column = std::pair<std::string, std::string>;
+
+static ParameterList get_valid_sweep_params() {
+  ParameterList p;
+  p.set<std::string>("results file", "");
+  p.set<bool>("warm start", true);
+  p.sublist("samples");
+  return p;
+}
+
+static std::vector<Column> get_columns(ParameterList const& sample) {
+  std::vector<Column> columns;
+  for (auto es = sample.begin(); es != sample.end(); ++es) {
+    auto es_name = sample.name(es);
+    GOAL_ALWAYS_ASSERT(sample.isSublist(es_name));
+    auto mp = sample.sublist(es_name);
+    for (auto it = mp.begin(); it != mp.end(); ++it) {
+      GOAL_ALWAYS_ASSERT(mp.isType<double>(mp.name(it)));
+      columns.push_back(Column(es_name, mp.name(it)));
+    }
+  }
+  return columns;
+}
+
+static void write_header(
+    std::string const& file, std::vector<Column> const& columns) {
+  if (PCU_Comm_Self()) return;
+  std::ofstream results(file.c_str());
+  results << "sample";
+  for (auto& c : columns) results << "," << c.first << ":" << c.second;
+  results << ",J,newton iters,seconds\n";
+}
+
+static void write_result(
+    std::string const& file,
+    std::string const& name,
+    ParameterList const& sample,
+    std::vector<Column> const& columns,
+    QoI* qoi,
+    int iters,
+    double seconds) {
+  if (PCU_Comm_Self()) return;
+  std::ofstream results(file.c_str(), std::ios::app);
+  results.precision(15);
+  results << name;
+  for (auto& c : columns)
+    results << "," << sample.sublist(c.first).get<double>(c.second);
+  results << ",";
+  if (qoi) results << qoi->get_value();
+  results << "," << iters << "," << seconds << "\n";
+}
+
+SweepSolver::SweepSolver(ParameterList const& p)
+    : StaticSolver(p) {
+  GOAL_ALWAYS_ASSERT(params.isSublist("sweep"));
+  GOAL_ALWAYS_ASSERT(params.isType<int>("nonlinear max iters"));
+  GOAL_ALWAYS_ASSERT(params.isType<double>("nonlinear tolerance"));
+  GOAL_ALWAYS_ASSERT(! is_adaptive);
+  GOAL_ALWAYS_ASSERT(! use_continuation);
+  auto& sp = params.sublist("sweep");
+  GOAL_ALWAYS_ASSERT(sp.isType<std::string>("results file"));
+  GOAL_ALWAYS_ASSERT(sp.isSublist("samples"));
+  sp.validateParameters(get_valid_sweep_params(), 0);
+  sp.get<bool>("warm start", true);
+}
+
+void SweepSolver::set_sample(ParameterList const& sample) {
+  for (auto es = sample.begin(); es != sample.end(); ++es) {
+    auto es_name = sample.name(es);
+    mech->set_material_params(es_name, sample.sublist(es_name));
+  }
+
+  // the evaluators read the material parameters when the model is
+  // built, so only the model is rebuilt. the indexer and the matrix
+  // graph are kept.
+  if (has_model) mech->destroy_model();
+  has_model = false;
+}
+
+void SweepSolver::zero_solution() {
+  auto u = mech->get_u();
+  for (size_t i = 0; i < u.size(); ++i)
+    apf::zeroField(u[i]->get_apf_field());
+}
+
+void SweepSolver::solve() {
+  goal::print("solving");
+  auto sp = params.sublist("sweep");
+  auto file = sp.get<std::string>("results file");
+  auto warm_start = sp.get<bool>("warm start");
+  auto samples = sp.sublist("samples");
+  std::vector<Column> columns;
+
+  int num_samples = 0;
+  int num_iters = 0;
+  auto t0 = PCU_Time();
+  for (auto it = samples.begin(); it != samples.end(); ++it) {
+    auto name = samples.name(it);
+    GOAL_ALWAYS_ASSERT(samples.isSublist(name));
+    auto sample = samples.sublist(name);
+    if (num_samples == 0) {
+      columns = get_columns(sample);
+      write_header(file, columns);
+    }
+    GOAL_ALWAYS_ASSERT(get_columns(sample) == columns);
+    goal::print("** sample %s", name.c_str());
+
+    // solve with the updated material parameters
+    auto t1 = PCU_Time();
+    set_sample(sample);
+    if (! warm_start) zero_solution();
+    int iters = solve_primal();
+    auto t2 = PCU_Time();
+
+    auto qoi = mech->get_qoi();
+    write_result(file, name, sample, columns, qoi, iters, t2 - t1);
+    num_iters += iters;
+    ++num_samples;
+  }
+  auto t3 = PCU_Time();
+  write_output(0, 0.0);
+  goal::print(" > samples: %d", num_samples);
+  goal::print(" > newton iterations: %d", num_iters);
+  if (linear_solver->get_num_iters() > 0)
+    goal::print(" > krylov iterations: %ld", linear_solver->get_num_iters());
+  goal::print(" > sweep time: %f seconds", t3 - t0);
+}
+
+} // end namespace ml
@@ -0,0 +1,51 @@
+#ifndef ml_sweep_solver_hpp
+#define ml_sweep_solver_hpp
+
+/// @file ml_sweep_solver.hpp
+
+#include "ml_static_solver.hpp"
+
+namespace ml {
+
+/// @brief A static solver for sweeps over material parameter samples.
+/// @details The discretization, the indexer and the matrix graph are
+/// built once and shared by all samples. Each sample overrides the
+/// material parameters of some element sets, rebuilds only the model,
+/// and solves the primal problem starting from the solution of the
+/// previous sample. The `sweep` sublist holds the `results file` and
+/// the `samples` sublist, whose entries are solved in order and each
+/// hold element set sublists of material parameters to override:
+///
+/// ```
+/// sweep:
+///   results file: sweep.csv
+///   warm start: true
+///   samples:
+///     s0: { box: { E: 1000.0, Y: 10.0 } }
+///     s1: { box: { E: 1100.0, Y: 12.0 } }
+/// ```
+///
+/// One line per sample is appended to the results file with the sample
+/// name, the overridden parameters, the qoi value (if any), the Newton
+/// iterations and the solve time. All samples must override the same
+/// parameters. With `warm start` false, each sample starts from zero.
+class SweepSolver : public StaticSolver {
+
+  public:
+
+    /// @brief Construct the sweep solver.
+    /// @param p The full parameter list describing this solver.
+    SweepSolver(ParameterList const& p);
+
+    /// @brief Run the solver.
+    void solve();
+
+  private:
+
+    void set_sample(ParameterList const& sample);
+    void zero_solution();
+};
+
+} // end namespace ml
+
+#endif
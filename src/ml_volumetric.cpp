@@ -1,3 +1,4 @@
+#include <type_traits>
 #include <goal_discretization.hpp>
 #include <goal_ev_gather.hpp>
 #include <goal_ev_basis.hpp>
@@ -5,11 +6,15 @@
 #include <goal_ev_resid.hpp>
 
 #include "ml_mechanics.hpp"
+#include "ml_ev_cached_basis.hpp"
 #include "ml_ev_kinematics.hpp"
 #include "ml_ev_elastic.hpp"
 #include "ml_ev_J2.hpp"
 #include "ml_ev_first_pk.hpp"
+#include "ml_ev_condensed_pressure.hpp"
 #include "ml_ev_momentum_resid.hpp"
+#include "ml_ev_error.hpp"
+#include "ml_ev_recover_stress.hpp"
 
 using Teuchos::RCP;
 using Teuchos::rcp;
@@ -19,7 +24,6 @@ template <typename EvalT>
 void ml::Mechanics::register_volumetric(goal::FieldManager fm) {
 
   std::vector<goal::Field*> disp = u;
-  goal::Field* press = 0;
 
   // get the current entity type to operate on
   auto type = disc->get_elem_type(elem_set);
@@ -41,7 +45,12 @@ void ml::Mechanics::register_volumetric(goal::FieldManager fm) {
   }
 
   { // set the displacement field basis functions
-    auto ev = rcp(new goal::Basis<EvalT, Traits>(disp[0], type));
+    RCP<PHX::Evaluator<Traits> > ev;
+    if (basis_cache)
+      ev = rcp(new CachedBasis<EvalT, Traits>(
+            disp[0], basis_cache, elem_set, type));
+    else
+      ev = rcp(new goal::Basis<EvalT, Traits>(disp[0], type));
     fm->registerEvaluator<EvalT>(ev);
   }
 
@@ -58,14 +67,23 @@ void ml::Mechanics::register_volumetric(goal::FieldManager fm) {
   { // compute the Cauchy stress tensor
     RCP<PHX::Evaluator<Traits> > ev;
     if (model == "elastic")
-      ev = rcp(new ml::Elastic<EvalT, Traits>(disp, states, mp, type));
+      ev = rcp(new ml::Elastic<EvalT, Traits>(disp, mp, type));
     else if (model == "J2")
       ev = rcp(new ml::J2<EvalT, Traits>(disp, states, mp, type));
     fm->registerEvaluator<EvalT>(ev);
   }
 
+  // condense the discontinuous pressure on each element
+  if (is_mixed) {
+    auto d = p_order - 1;
+    auto ev = rcp(new CondensedPressure<EvalT, Traits>(
+          disp, indexer, d, type));
+    fm->registerEvaluator<EvalT>(ev);
+  }
+
   { // pull back the Cauchy stress tensor
-    auto ev = rcp(new FirstPK<EvalT, Traits>(disp, press, small_strain, type));
+    auto ev = rcp(new FirstPK<EvalT, Traits>(
+          disp, is_mixed, small_strain, type));
     fm->registerEvaluator<EvalT>(ev);
   }
 
@@ -82,6 +100,22 @@ void ml::Mechanics::register_volumetric(goal::FieldManager fm) {
     fm->requireField<EvalT>(*ev->evaluatedFields()[0]);
   }
 
+  // recover the Cauchy stress for output when requested
+  bool is_residual = std::is_same<EvalT, Residual>::value;
+  if (is_primal && is_residual && stress) {
+    auto ev = rcp(new RecoverStress<EvalT, Traits>(disp, stress, type));
+    fm->registerEvaluator<EvalT>(ev);
+    fm->requireField<EvalT>(*ev->evaluatedFields()[0]);
+  }
+
+  // compute the element-wise dual weighted residual
+  if (is_error) {
+    auto ev = rcp(new ErrorIndicator<EvalT, Traits>(
+          disp, states, error, type));
+    fm->registerEvaluator<EvalT>(ev);
+    fm->requireField<EvalT>(*ev->evaluatedFields()[0]);
+  }
+
   // set the FAD data and finalize the PHX field maanger registration.
   goal::set_extended_data_type_dims(indexer, fm, type);
   fm->postRegistrationSetupForType<EvalT>(NULL);
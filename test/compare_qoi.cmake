@@ -0,0 +1,42 @@
+# Run two input decks and require them to print the same sequence of
+# J(u) values to DIGITS significant digits (default ten). With LAST set
+# only the final J(u) values are compared.
+
+if(NOT DIGITS)
+  set(DIGITS 10)
+endif()
+math(EXPR decimals "${DIGITS} - 1")
+string(REPEAT "." ${decimals} kept)
+
+function(get_qoi_values deck values)
+  execute_process(
+    COMMAND ${MPIEXE} ${MPIFLAGS} ${NP} ${MLEXE} ${deck}.yaml
+    OUTPUT_VARIABLE out
+    RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${deck} failed:\n${out}")
+  endif()
+  set(number "-?[0-9]\\.[0-9]+e[-+][0-9]+")
+  string(REGEX MATCHALL "J\\(u\\) = ${number}" lines "${out}")
+  set(qois)
+  foreach(line ${lines})
+    string(REGEX REPLACE "J\\(u\\) = (-?[0-9]\\.${kept})[0-9]*(e.*)"
+      "\\1\\2" qoi "${line}")
+    list(APPEND qois ${qoi})
+  endforeach()
+  set(${values} "${qois}" PARENT_SCOPE)
+endfunction()
+
+get_qoi_values(${FIRST} first)
+get_qoi_values(${SECOND} second)
+if(NOT first)
+  message(FATAL_ERROR "${FIRST} printed no J(u) values")
+endif()
+if(LAST AND second)
+  list(GET first -1 first)
+  list(GET second -1 second)
+endif()
+if(NOT "${first}" STREQUAL "${second}")
+  message(FATAL_ERROR
+    "J(u) differs:\n${FIRST}: ${first}\n${SECOND}: ${second}")
+endif()